@@ -0,0 +1,108 @@
+#include "Arena.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace Scoop::Memory
+{
+    // Constructor
+
+    Arena::Arena() = default;
+
+    // Destructor
+
+    Arena::~Arena()
+    {
+        // Weak references expire before any object is destroyed, including those whose destruction is skipped
+
+        for (Object *object : this->weaklyReferenced)
+            WeakReference::ObjectDestroyed(object);
+
+        // Objects are destroyed newest first. Releasing another object of this arena only decrements its
+        // count, since arena objects are never deleted individually, and the chunks outlive every destructor
+
+        for (size_t i = this->objects.size(); i > 0; i--)
+            this->objects[i - 1]->~Object();
+
+        for (void *allocation : this->largeAllocations)
+            free(allocation);
+
+        for (void *chunk : this->chunks)
+        {
+#ifdef _WIN32
+            _aligned_free(chunk);
+#else
+            free(chunk);
+#endif
+        }
+    }
+
+    // Owning arena
+
+    Arena *Arena::Of(const Object *object)
+    {
+        if (object == nullptr || !object->IsArenaAllocated())
+            return nullptr;
+
+        uintptr_t chunk = (uintptr_t)object & ~(uintptr_t)(ChunkSize - 1);
+        return *(Arena **)chunk;
+    }
+
+    // Allocation
+
+    void *Arena::AllocateFromChunk(size_t size, size_t alignment)
+    {
+        size_t padding = (size_t)(-(uintptr_t)this->cursor & (alignment - 1));
+        if (this->cursor == nullptr || size + padding > this->remaining)
+        {
+            this->chunks.reserve(this->chunks.size() + 1);
+
+#ifdef _WIN32
+            char *chunk = (char *)_aligned_malloc(ChunkSize, ChunkSize);
+#else
+            char *chunk = (char *)aligned_alloc(ChunkSize, ChunkSize);
+#endif
+            if (chunk == nullptr)
+                throw std::bad_alloc();
+
+            this->chunks.push_back(chunk);
+            *(Arena **)chunk = this;
+
+            this->cursor = chunk + HeaderSize;
+            this->remaining = ChunkSize - HeaderSize;
+            padding = (size_t)(-(uintptr_t)this->cursor & (alignment - 1));
+        }
+
+        void *ptr = this->cursor + padding;
+        this->cursor += size + padding;
+        this->remaining -= size + padding;
+
+        return ptr;
+    }
+
+    void *Arena::Allocate(size_t size, size_t alignment)
+    {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > alignof(std::max_align_t))
+            throw Error::Create("Arena", "Allocate", "Alignment %zu is not a power of two no greater than %zu.", alignment, alignof(std::max_align_t));
+
+        if (size < LargeSize)
+            return this->AllocateFromChunk(size == 0 ? 1 : size, alignment);
+
+        // Large blocks get their own allocation, so they do not waste the remainder of a chunk
+
+        this->largeAllocations.reserve(this->largeAllocations.size() + 1);
+
+        void *ptr = malloc(size);
+        if (ptr == nullptr)
+            throw std::bad_alloc();
+
+        this->largeAllocations.push_back(ptr);
+
+        return ptr;
+    }
+
+    // Chunk count
+
+    size_t Arena::ChunkCount() const
+    { return this->chunks.size(); }
+}
\ No newline at end of file
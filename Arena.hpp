@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Scoop::Memory
+{
+    class String;
+
+    // Types whose destructor only frees memory owned by the arena, so that teardown may skip it
+
+    template <class T> struct IsArenaTrivial : std::false_type { };
+
+#ifndef SCOOP_MEMORY_INSTRUMENTATION
+    template <> struct IsArenaTrivial<String> : std::true_type { }; // instrumentation must observe every destruction
+#endif
+
+    class Arena
+    {
+        friend class WeakReference;
+
+        public:
+            static constexpr size_t ChunkSize = 64 * 1024;
+
+        private:
+            // Chunks are aligned to their size, so the owning arena is found from any address inside one
+
+            static constexpr size_t HeaderSize = alignof(std::max_align_t);
+            static constexpr size_t LargeSize = ChunkSize / 4;
+
+            std::vector<void *> chunks;
+            std::vector<void *> largeAllocations;
+            std::vector<Object *> objects;
+            std::vector<Object *> weaklyReferenced;
+
+            char *cursor = nullptr;
+            size_t remaining = 0;
+
+            void *AllocateFromChunk(size_t size, size_t alignment);
+
+        public:
+            Arena();
+            ~Arena();
+
+            // Owning arena
+
+            static Arena *Of(const Object *object);
+
+            // Allocation
+
+            void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+            template <class T, typename ... Args> T *New(Args && ... args)
+            {
+                static_assert(std::is_base_of<Object, T>::value, "Arena can only allocate Object subclasses.");
+                static_assert(sizeof(T) + alignof(T) <= ChunkSize - HeaderSize, "Object is too large for an arena chunk.");
+
+                void *memory = this->AllocateFromChunk(sizeof(T), alignof(T));
+
+                // Reserve the teardown entry first, so that registering the object cannot fail after construction
+
+                if (!IsArenaTrivial<T>::value)
+                    this->objects.push_back(nullptr);
+
+                T *object;
+                Object::constructingInArena = true;
+
+                try { object = ::new (memory) T(std::forward<Args>(args) ...); }
+                catch (...)
+                {
+                    Object::constructingInArena = false;
+                    if (!IsArenaTrivial<T>::value)
+                        this->objects.pop_back();
+
+                    throw;
+                }
+
+                if (!IsArenaTrivial<T>::value)
+                    this->objects.back() = object;
+
+                return object;
+            }
+
+            // Chunk count
+
+            size_t ChunkCount() const;
+
+            // Prohibit copying
+
+            Arena(const Arena &) = delete;
+            void operator=(const Arena &) = delete;
+
+            // Prohibit moving
+
+            Arena(Arena &&) = delete;
+            void operator=(Arena &&) = delete;
+    };
+}
\ No newline at end of file
@@ -1,53 +1,186 @@
 #include "Array.hpp"
 
+#include <algorithm>
+
 namespace Scoop::Memory
 {
-    Array::~Array()
-    { this->Clear(); }
+    Array::~Array() = default;
+
+    // Storage
+
+    Array::Storage::~Storage()
+    {
+        for (Object *obj : this->objects)
+            obj->Release();
+    }
+
+    const std::vector<Object *> &Array::Objects() const
+    {
+        static const std::vector<Object *> empty;
+        return this->storage != nullptr ? this->storage->objects : empty;
+    }
+
+    std::vector<Object *> &Array::MutableObjects(const char *methodName)
+    {
+        if (this->frozen)
+            throw Error::Create("Array", methodName, "Array is frozen.");
+
+        if (this->storage == nullptr)
+            this->storage = std::make_shared<Storage>();
+        else if (this->storage.use_count() > 1)
+        {
+            // Copy on write: the new storage holds its own reference to each object
+
+            std::shared_ptr<Storage> copy = std::make_shared<Storage>();
+            copy->objects = this->storage->objects;
+
+            for (Object *obj : copy->objects)
+                obj->Retain();
+
+            this->storage = copy;
+        }
+
+        return this->storage->objects;
+    }
+
+    void Array::ReindexFrom(size_t start)
+    {
+        const std::vector<Object *> &objects = this->Objects();
+        size_t size = objects.size();
+
+        for (size_t i = start; i < size; i++)
+            (*this->index)[objects[i]] = i;
+    }
+
+    // Cycle collection
+
+    bool Array::HasChildren() const
+    { return true; }
+
+    void Array::EnumerateChildren(ChildVisitor visitor, void *context) const
+    {
+        // Shared storage holds one reference per object for all of its owners, so only unshared storage is traversed
+
+        if (this->storage == nullptr || this->storage.use_count() > 1)
+            return;
+
+        for (Object *obj : this->storage->objects)
+            visitor(obj, context);
+    }
+
+    void Array::ClearChildren()
+    {
+        std::shared_ptr<Storage> old = std::move(this->storage);
+
+        if (this->index != nullptr)
+            this->index->clear();
+    }
 
     // Copy other array
 
     void Array::Copy(const Array *array)
     {
-        this->Clear();
-        
-        this->objects = array->objects;
-        for (Object *object : this->objects)
-            object->Retain();
+        if (array == this)
+            return;
+
+        if (this->frozen)
+            throw Error::Create("Array", "Copy", "Array is frozen.");
+
+        std::shared_ptr<Storage> old = std::move(this->storage);
+        this->storage = array->storage;
+
+        if (this->index != nullptr)
+        {
+            this->index->clear();
+            this->ReindexFrom(0);
+        }
+    }
+
+    // Immutability
+
+    bool Array::IsFrozen() const
+    { return this->frozen; }
+
+    void Array::Freeze()
+    { this->frozen = true; }
+
+    Array *Array::Snapshot() const
+    {
+        Array *snapshot = new Array();
+        snapshot->storage = this->storage;
+        snapshot->frozen = true;
+
+        return snapshot;
+    }
+
+    // Identity index
+
+    bool Array::IsIndexed() const
+    { return this->index != nullptr; }
+
+    void Array::SetIndexed(bool indexed)
+    {
+        if (!indexed)
+            this->index.reset();
+        else if (this->index == nullptr)
+        {
+            this->index.reset(new std::unordered_map<Object *, size_t>());
+            this->index->reserve(this->Count());
+            this->ReindexFrom(0);
+        }
     }
 
     // Object count
 
     size_t Array::Count() const
-    { return this->objects.size(); }
+    { return this->Objects().size(); }
 
     void Array::Clear()
     {
-        for (Object *obj : this->objects)
-            obj->Release();
+        if (this->frozen)
+            throw Error::Create("Array", "Clear", "Array is frozen.");
+
+        // Objects are released once the storage is detached, so a destructor that reaches this array sees it empty
 
-        objects.clear();
+        std::shared_ptr<Storage> old = std::move(this->storage);
+
+        if (this->index != nullptr)
+            this->index->clear();
     }
 
     // Indexing
 
     Object *Array::ObjectAtIndex(size_t index) const
     {
-        if (index >= this->objects.size())
-            throw Error::IndexError("Array", "ObjectAtIndex", index, this->objects.size());
+        const std::vector<Object *> &objects = this->Objects();
+        if (index >= objects.size())
+            throw Error::IndexError("Array", "ObjectAtIndex", index, objects.size());
             
-        return this->objects[index];
+        return objects[index];
     }
 
     // Check if array contains object
     
     bool Array::Contains(Object *obj, size_t *index) const
     {
-        size_t size = this->objects.size();
+        if (this->index != nullptr)
+        {
+            auto position = this->index->find(obj);
+            if (position == this->index->end())
+                return false;
+
+            if (index != nullptr)
+                *index = position->second;
+
+            return true;
+        }
+
+        const std::vector<Object *> &objects = this->Objects();
+        size_t size = objects.size();
         
         for (size_t i = 0; i < size; i++)
         {
-            if (this->objects[i] == obj)
+            if (objects[i] == obj)
             {
                 if (index != nullptr)
                     *index = i;
@@ -63,50 +196,139 @@ namespace Scoop::Memory
 
     void Array::AddObject(Object *obj)
     {
-        if (this->Contains(obj))
+        if (this->frozen)
+            throw Error::Create("Array", "AddObject", "Array is frozen.");
+
+        if (this->index != nullptr)
+        {
+            if (!this->index->emplace(obj, this->Count()).second)
+                return;
+        }
+        else if (this->Contains(obj))
             return;
 
         obj->Retain();
-        this->objects.push_back(obj);
+        this->MutableObjects("AddObject").push_back(obj);
     }
 
     void Array::AddObjects(const Array *objects)
     {
-        size_t size = objects->objects.size();
+        // Hold the source storage, since copying on write may otherwise drop it
+
+        std::shared_ptr<Storage> source = objects->storage;
+        if (source == nullptr)
+            return;
+
+        size_t size = source->objects.size();
+
+        std::vector<Object *> &target = this->MutableObjects("AddObjects");
+        target.reserve(target.size() + size);
+        if (this->index != nullptr)
+            this->index->reserve(this->index->size() + size);
+
         for (size_t i = 0; i < size; i++)
-            this->AddObject(objects->objects[i]);
+            this->AddObject(source->objects[i]);
     }
 
     // Remove objects
 
     void Array::RemoveObjectAtIndex(size_t i)
     {
-        if (i >= this->objects.size())
-            throw Error::IndexError("Array", "RemoveObjectAtIndex", i, this->objects.size());
+        std::vector<Object *> &objects = this->MutableObjects("RemoveObjectAtIndex");
+        if (i >= objects.size())
+            throw Error::IndexError("Array", "RemoveObjectAtIndex", i, objects.size());
+
+        Object *obj = objects[i];
+        objects.erase(objects.begin() + i);
+
+        if (this->index != nullptr)
+        {
+            this->index->erase(obj);
+            this->ReindexFrom(i);
+        }
+
+        obj->Release();
+    }
+
+    void Array::RemoveObjectAtIndexUnordered(size_t i)
+    {
+        std::vector<Object *> &objects = this->MutableObjects("RemoveObjectAtIndexUnordered");
+        size_t size = objects.size();
+        if (i >= size)
+            throw Error::IndexError("Array", "RemoveObjectAtIndexUnordered", i, size);
+
+        Object *obj = objects[i];
+        if (this->index != nullptr)
+            this->index->erase(obj);
+
+        // Move the last object into the gap instead of shifting the tail
 
-        this->objects[i]->Release();
-        this->objects.erase(this->objects.begin() + i);
+        objects[i] = objects[size - 1];
+        objects.pop_back();
+
+        if (this->index != nullptr && i < size - 1)
+            (*this->index)[objects[i]] = i;
+
+        obj->Release();
     }
 
     void Array::RemoveObject(Object *obj)
     {
-        size_t size = this->objects.size();
-        for (size_t i = 0; i < size; i++)
+        if (this->frozen)
+            throw Error::Create("Array", "RemoveObject", "Array is frozen.");
+
+        size_t i;
+        if (!this->Contains(obj, &i))
+            return;
+
+        // With the index, the object's position is known and the last object takes its place, so removal is O(1)
+
+        if (this->index != nullptr)
+            this->RemoveObjectAtIndexUnordered(i);
+        else
+            this->RemoveObjectAtIndex(i);
+    }
+
+    void Array::RemoveObjects(const Array *objects)
+    {
+        if (objects == nullptr)
+            throw Error::NullError("Array", "RemoveObjects", "objects");
+
+        if (objects == this)
         {
-            Object *test = this->objects[i];
-            if (test == obj)
-            {
-                test->Release();
-                this->objects.erase(this->objects.begin() + i);
-                break;
-            }
+            this->Clear();
+            return;
+        }
+
+        // Look up removals in a hash set unless there are only a few of them
+
+        std::shared_ptr<Storage> source = objects->storage;
+        if (source == nullptr)
+            return;
+
+        const std::vector<Object *> &toRemove = source->objects;
+        if (objects->index != nullptr)
+            this->RemoveObjectsIf([&objects](Object *obj) { return objects->index->count(obj) != 0; });
+        else if (toRemove.size() <= 8)
+            this->RemoveObjectsIf([&toRemove](Object *obj) { return std::find(toRemove.begin(), toRemove.end(), obj) != toRemove.end(); });
+        else
+        {
+            std::unordered_set<Object *> set(toRemove.begin(), toRemove.end());
+            this->RemoveObjectsIf([&set](Object *obj) { return set.count(obj) != 0; });
         }
     }
 
-    void Array::RemoveObjects(const Array *objects)
+    void Array::ReleaseRemovedObjects(const std::vector<Object *> &removed)
     {
-        size_t size = objects->objects.size();
-        for (size_t i = 0; i < size; i++)
-            this->RemoveObject(objects->objects[i]);
+        if (this->index != nullptr && !removed.empty())
+        {
+            for (Object *obj : removed)
+                this->index->erase(obj);
+
+            this->ReindexFrom(0);
+        }
+
+        for (Object *obj : removed)
+            obj->Release();
     }
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace Scoop::Memory
@@ -7,16 +10,53 @@ namespace Scoop::Memory
     class Array : public Object
     {
         private:
-            std::vector<Object *> objects;
+            // Storage is shared between copies and snapshots, and copied before a shared storage is modified
+
+            struct Storage
+            {
+                std::vector<Object *> objects;
+                ~Storage();
+            };
+
+            std::shared_ptr<Storage> storage;
+            bool frozen = false;
+
+            // Optional identity index mapping each object to its position, for O(1) membership tests and removal
+
+            std::unique_ptr<std::unordered_map<Object *, size_t>> index;
+
+            const std::vector<Object *> &Objects() const;
+            std::vector<Object *> &MutableObjects(const char *methodName);
+
+            void ReindexFrom(size_t start);
+
+            void ReleaseRemovedObjects(const std::vector<Object *> &removed);
 
         public:
             Array() = default;
             ~Array();
 
-            // Copy other array
+            // Cycle collection
+
+            bool HasChildren() const override;
+            void EnumerateChildren(ChildVisitor visitor, void *context) const override;
+            void ClearChildren() override;
+
+            // Copy other array, sharing its storage until either is modified
 
             void Copy(const Array *array);
 
+            // Immutability
+
+            bool IsFrozen() const;
+            void Freeze();
+            Array *Snapshot() const;
+
+            // Identity index
+
+            bool IsIndexed() const;
+            void SetIndexed(bool indexed);
+
             // Object count
 
             size_t Count() const;
@@ -46,7 +86,41 @@ namespace Scoop::Memory
             // Remove objects
 
             void RemoveObjectAtIndex(size_t i);
+            void RemoveObjectAtIndexUnordered(size_t i);
             void RemoveObject(Object *obj);
             void RemoveObjects(const Array *objects);
+
+            template <class Predicate> void RemoveObjectsIf(Predicate predicate)
+            {
+                // Compact the kept objects in one pass, then release the removed objects together
+
+                std::vector<Object *> &objects = this->MutableObjects("RemoveObjectsIf");
+                std::vector<Object *> removed;
+                size_t size = objects.size(), kept = 0, i = 0;
+
+                try
+                {
+                    for (; i < size; i++)
+                    {
+                        Object *obj = objects[i];
+                        if (predicate(obj))
+                            removed.push_back(obj);
+                        else
+                            objects[kept++] = obj;
+                    }
+                }
+                catch (...)
+                {
+                    for (; i < size; i++)
+                        objects[kept++] = objects[i];
+
+                    objects.resize(kept);
+                    this->ReleaseRemovedObjects(removed);
+                    throw;
+                }
+
+                objects.resize(kept);
+                this->ReleaseRemovedObjects(removed);
+            }
     };
 }
\ No newline at end of file
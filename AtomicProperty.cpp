@@ -0,0 +1,150 @@
+#include "AtomicProperty.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace Scoop::Memory
+{
+    // Records are never freed, so readers may traverse the list without locking
+
+    static std::atomic<HazardPointers::Record *> records { nullptr };
+    static std::atomic<size_t> recordCount { 0 };
+
+    // Objects retired by threads that have since exited
+
+    struct OrphanList
+    {
+        std::mutex mutex;
+        std::vector<Object *> objects;
+    };
+
+    static OrphanList &Orphans()
+    {
+        static OrphanList *orphans = new OrphanList();
+        return *orphans;
+    }
+
+    static void ReleaseUnprotected(std::vector<Object *> &retired)
+    {
+        std::vector<Object *> hazards;
+        for (HazardPointers::Record *record = records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+        {
+            if (Object *hazard = record->hazard.load(std::memory_order_seq_cst))
+                hazards.push_back(hazard);
+        }
+
+        std::sort(hazards.begin(), hazards.end());
+
+        // Releasing may destroy objects that retire others, so work on a detached list
+
+        std::vector<Object *> candidates;
+        candidates.swap(retired);
+
+        for (Object *obj : candidates)
+        {
+            if (std::binary_search(hazards.begin(), hazards.end(), obj))
+                retired.push_back(obj);
+            else
+                obj->Release();
+        }
+    }
+
+    struct ThreadState
+    {
+        HazardPointers::Record *record = nullptr;
+        std::vector<Object *> retired;
+
+        ~ThreadState()
+        {
+            ReleaseUnprotected(this->retired);
+
+            if (!this->retired.empty())
+            {
+                OrphanList &orphans = Orphans();
+                std::lock_guard<std::mutex> lock(orphans.mutex);
+                orphans.objects.insert(orphans.objects.end(), this->retired.begin(), this->retired.end());
+            }
+
+            if (this->record != nullptr)
+                this->record->active.store(false, std::memory_order_release);
+        }
+    };
+
+    static thread_local ThreadState threadState;
+
+    // Current record
+
+    HazardPointers::Record *HazardPointers::Current()
+    {
+        if (threadState.record != nullptr)
+            return threadState.record;
+
+        // Reuse the record of an exited thread before adding a new one
+
+        for (Record *record = records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+        {
+            bool expected = false;
+            if (!record->active.load(std::memory_order_relaxed) && record->active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return threadState.record = record;
+        }
+
+        Record *record = new Record();
+        record->active.store(true, std::memory_order_relaxed);
+        record->next = records.load(std::memory_order_relaxed);
+
+        while (!records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed));
+
+        recordCount.fetch_add(1, std::memory_order_relaxed);
+        return threadState.record = record;
+    }
+
+    // Atomic reference counting is required, since readers retain concurrently
+
+    void HazardPointers::AssertAtomic(const Object *obj, const char *className, const char *methodName)
+    {
+        if (obj != nullptr && obj->GetReferenceCounting() != ReferenceCounting::Atomic)
+            throw Error::Create(className, methodName, "Object must use atomic reference counting.");
+    }
+
+    // Retire
+
+    void HazardPointers::Retire(Object *obj)
+    {
+        if (obj == nullptr)
+            throw Error::NullError("HazardPointers", "Retire", "obj");
+
+        std::vector<Object *> &retired = threadState.retired;
+        retired.push_back(obj);
+
+        // Scanning is amortized over a number of retirements proportional to the number of readers
+
+        if (retired.size() >= 2 * recordCount.load(std::memory_order_relaxed) + 16)
+            ReleaseUnprotected(retired);
+    }
+
+    void HazardPointers::Reclaim()
+    {
+        ReleaseUnprotected(threadState.retired);
+
+        std::vector<Object *> orphaned;
+        OrphanList &orphans = Orphans();
+
+        {
+            std::lock_guard<std::mutex> lock(orphans.mutex);
+            orphaned.swap(orphans.objects);
+        }
+
+        ReleaseUnprotected(orphaned);
+
+        std::lock_guard<std::mutex> lock(orphans.mutex);
+        orphans.objects.insert(orphans.objects.end(), orphaned.begin(), orphaned.end());
+    }
+
+    size_t HazardPointers::PendingCount()
+    {
+        OrphanList &orphans = Orphans();
+        std::lock_guard<std::mutex> lock(orphans.mutex);
+        return threadState.retired.size() + orphans.objects.size();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+
+namespace Scoop::Memory
+{
+    // Hazard pointers: a reader publishes the object it is about to retain, and a writer defers
+    // releasing a replaced object until no reader has it published
+
+    class HazardPointers
+    {
+        public:
+            struct Record
+            {
+                std::atomic<Object *> hazard { nullptr };
+                std::atomic<bool> active { false };
+                Record *next = nullptr;
+            };
+
+            // The calling thread's record
+
+            static Record *Current();
+
+            // Throws unless obj is nullptr or uses atomic reference counting
+
+            static void AssertAtomic(const Object *obj, const char *className, const char *methodName);
+
+            // Release obj once no hazard pointer refers to it
+
+            static void Retire(Object *obj);
+
+            // Release every retired object that is no longer hazardous
+
+            static void Reclaim();
+
+            // Number of retired objects still awaiting release
+
+            static size_t PendingCount();
+
+            // Prohibit construction
+
+            HazardPointers() = delete;
+    };
+
+    template <typename T> class AtomicProperty
+    {
+        private:
+            std::atomic<T *> obj { nullptr };
+
+        public:
+            AtomicProperty() = default;
+            explicit AtomicProperty(T *newObj) { this->Store(newObj); }
+
+            ~AtomicProperty()
+            {
+                // No reader can be loading from a property that is being destroyed
+
+                if (T *oldObj = this->obj.load(std::memory_order_acquire))
+                    oldObj->Release();
+            }
+
+            // Returns the held object retained, or nullptr; the caller must release it
+
+            T *Load() const
+            {
+                HazardPointers::Record *record = HazardPointers::Current();
+                T *current = this->obj.load(std::memory_order_acquire);
+
+                // Publish the hazard, then confirm the object was not replaced before it became visible
+
+                while (current != nullptr)
+                {
+                    record->hazard.store(current, std::memory_order_seq_cst);
+
+                    T *confirmed = this->obj.load(std::memory_order_seq_cst);
+                    if (confirmed == current)
+                        break;
+
+                    current = confirmed;
+                }
+
+                if (current != nullptr)
+                    current->Retain();
+
+                record->hazard.store(nullptr, std::memory_order_release);
+                return current;
+            }
+
+            // Replaces the held object; the previous one is released once no reader can still be retaining it
+
+            void Store(T *newObj)
+            {
+                HazardPointers::AssertAtomic(newObj, "AtomicProperty", "Store");
+
+                if (newObj != nullptr)
+                    newObj->Retain();
+
+                // The exchange is sequentially consistent with the readers' hazard store and confirming load, so either a
+                // reader sees the new object or the hazard scan in Retire sees the reader's hazard
+
+                T *oldObj = this->obj.exchange(newObj, std::memory_order_seq_cst);
+                if (oldObj != nullptr)
+                    HazardPointers::Retire(oldObj);
+            }
+
+            T *operator=(T *newObj)
+            {
+                this->Store(newObj);
+                return newObj;
+            }
+
+            // Prohibit copying
+
+            AtomicProperty(const AtomicProperty &) = delete;
+            void operator=(const AtomicProperty &) = delete;
+    };
+}
\ No newline at end of file
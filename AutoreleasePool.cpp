@@ -0,0 +1,60 @@
+#include "AutoreleasePool.hpp"
+
+namespace Scoop::Memory
+{
+    // Each thread has its own stack of pools
+
+    static thread_local AutoreleasePool *currentPool = nullptr;
+
+    AutoreleasePool::AutoreleasePool() : parent(currentPool)
+    { currentPool = this; }
+
+    AutoreleasePool::~AutoreleasePool()
+    {
+        this->Drain();
+        currentPool = this->parent;
+    }
+
+    // Current pool
+
+    AutoreleasePool *AutoreleasePool::Current()
+    { return currentPool; }
+
+    // Object count
+
+    size_t AutoreleasePool::Count() const
+    { return this->objects.size(); }
+
+    // Add object
+
+    void AutoreleasePool::AddObject(Object *obj)
+    {
+        if (obj == nullptr)
+            throw Error::NullError("AutoreleasePool", "AddObject", "obj");
+
+        this->objects.push_back(obj);
+    }
+
+    // Release all objects
+
+    void AutoreleasePool::Drain()
+    {
+        // A drain ends each turn of an event loop, which makes it a safe point for incremental cycle collection
+
+        CycleCollector::Poll();
+
+        std::vector<Object *> batch;
+
+        // Releasing an object may autorelease others into this pool, so drain until it stays empty
+
+        while (!this->objects.empty())
+        {
+            batch.swap(this->objects);
+
+            for (Object *obj : batch)
+                obj->Release();
+
+            batch.clear();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+namespace Scoop::Memory
+{
+    class AutoreleasePool
+    {
+        private:
+            std::vector<Object *> objects;
+            AutoreleasePool *parent;
+
+        public:
+            AutoreleasePool();
+            ~AutoreleasePool();
+
+            // Current pool
+
+            static AutoreleasePool *Current();
+
+            // Object count
+
+            size_t Count() const;
+
+            // Add object
+
+            void AddObject(Object *obj);
+
+            // Release all objects
+
+            void Drain();
+
+            // Prohibit copying
+
+            AutoreleasePool(const AutoreleasePool &) = delete;
+            void operator=(const AutoreleasePool &) = delete;
+
+            // Prohibit moving
+
+            AutoreleasePool(AutoreleasePool &&) = delete;
+            void operator=(AutoreleasePool &&) = delete;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,1032 @@
+#include "Benchmarks.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#include <malloc.h>
+#define HEAP_USAGE_AVAILABLE
+#endif
+
+#define BEGIN_BENCHMARK(section) const char *_section = section; printf("Beginning benchmarks for %s...\n", _section);
+#define END_BENCHMARK { printf("All benchmarks complete for %s.\n", _section); }
+
+// Prevents the optimizer from discarding benchmarked work
+
+static volatile size_t sink;
+
+// Bytes currently allocated from the heap, or 0 if the platform cannot report it
+
+static size_t HeapUsage()
+{
+#ifdef HEAP_USAGE_AVAILABLE
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+template <typename Function>
+static void Benchmark(const char *name, size_t iterations, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function(iterations);
+    auto end = std::chrono::steady_clock::now();
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("[%s] %zu iterations, %.2f ns/iteration.\n", name, iterations, nanoseconds / (double)iterations);
+}
+
+// Like Benchmark, but reports throughput for functions that process a given number of bytes per iteration
+
+template <typename Function>
+static void BenchmarkThroughput(const char *name, size_t iterations, size_t bytes, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function(iterations);
+    auto end = std::chrono::steady_clock::now();
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("[%s] %zu iterations, %.2f GB/s.\n", name, iterations, (double)bytes * (double)iterations / nanoseconds);
+}
+
+namespace Scoop::Memory::BenchmarkScoopMemory
+{
+    void BenchmarkObject()
+    {
+        BEGIN_BENCHMARK("Object");
+
+        const size_t iterations = 10000000;
+
+        Object *object = new Object(ReferenceCounting::NonAtomic);
+        Benchmark("Object::Retain/Release (non-atomic)", iterations, [object](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                object->Retain();
+                object->Release();
+            }
+        });
+        object->Release();
+
+        object = new Object(ReferenceCounting::Atomic);
+        Benchmark("Object::Retain/Release (atomic)", iterations, [object](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                object->Retain();
+                object->Release();
+            }
+        });
+
+        Benchmark("Object::Retain/Release (atomic, 4 threads)", iterations, [object](size_t count)
+        {
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < 4; t++)
+            {
+                threads.emplace_back([object, count]()
+                {
+                    for (size_t i = 0; i < count / 4; i++)
+                    {
+                        object->Retain();
+                        object->Release();
+                    }
+                });
+            }
+
+            for (std::thread &thread : threads)
+                thread.join();
+        });
+
+        sink = object->GetReferenceCount();
+        object->Release();
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkString()
+    {
+        BEGIN_BENCHMARK("String");
+
+        Benchmark("String::Append (character, 1M characters)", 1000000, [](size_t count)
+        {
+            String *str = new String();
+            for (size_t i = 0; i < count; i++)
+                str->Append('x');
+
+            sink = str->Length();
+            str->Release();
+        });
+
+        Benchmark("String::Append (16-byte fragment, 16MB total)", 1000000, [](size_t count)
+        {
+            String *str = new String();
+            for (size_t i = 0; i < count; i++)
+                str->Append("0123456789abcdef");
+
+            sink = str->Length();
+            str->Release();
+        });
+
+        Benchmark("String::Append (16-byte fragment, reserved 16MB)", 1000000, [](size_t count)
+        {
+            String *str = new String();
+            str->Reserve(count * 16);
+            for (size_t i = 0; i < count; i++)
+                str->Append("0123456789abcdef");
+
+            sink = str->Length();
+            str->Release();
+        });
+
+        Benchmark("String::Insert (middle of 64KB string)", 10000, [](size_t count)
+        {
+            String *str = new String();
+            for (size_t i = 0; i < 64 * 1024 / 16; i++)
+                str->Append("0123456789abcdef");
+
+            for (size_t i = 0; i < count; i++)
+                str->Insert("xy", str->Length() / 2);
+
+            sink = str->Length();
+            str->Release();
+        });
+
+        Benchmark("String::AppendFormat (1M fields)", 1000000, [](size_t count)
+        {
+            String *str = new String();
+            for (size_t i = 0; i < count; i++)
+                str->AppendFormat("field%zu=%d;", i, (int)(i & 0xff));
+
+            sink = str->Length();
+            str->Release();
+        });
+
+        Benchmark("String::AppendFormat (1KB lines, 100k lines)", 100000, [](size_t count)
+        {
+            std::string message(1000, 'm');
+            String *str = new String();
+            str->Reserve(count * 1024);
+            for (size_t i = 0; i < count; i++)
+                str->AppendFormat("[%zu] %s\n", i, message.c_str());
+
+            sink = str->Length();
+            str->Release();
+        });
+
+        // The same fragments assembled in a StringBuilder, which never copies appended data until it is materialized or written
+
+        Benchmark("StringBuilder::Append (16-byte fragment, 16MB total)", 1000000, [](size_t count)
+        {
+            StringBuilder *builder = new StringBuilder();
+            for (size_t i = 0; i < count; i++)
+                builder->Append("0123456789abcdef");
+
+            sink = builder->Length();
+            builder->Release();
+        });
+
+        Benchmark("StringBuilder::Append + ToString (16-byte fragment, 16MB total)", 1000000, [](size_t count)
+        {
+            StringBuilder *builder = new StringBuilder();
+            for (size_t i = 0; i < count; i++)
+                builder->Append("0123456789abcdef");
+
+            String *str = builder->ToString();
+            sink = str->Length();
+            str->Release();
+            builder->Release();
+        });
+
+        Benchmark("StringBuilder::AppendFormat (1M fields)", 1000000, [](size_t count)
+        {
+            StringBuilder *builder = new StringBuilder();
+            for (size_t i = 0; i < count; i++)
+                builder->AppendFormat("field%zu=%d;", i, (int)(i & 0xff));
+
+            sink = builder->Length();
+            builder->Release();
+        });
+
+        int devNull = open("/dev/null", O_WRONLY);
+        StringBuilder *response = new StringBuilder();
+        for (size_t i = 0; i < 1000000; i++)
+            response->Append("0123456789abcdef");
+
+        Benchmark("StringBuilder::WriteTo (16MB in chunks)", 100, [response, devNull](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                response->WriteTo(devNull);
+            sink = response->ChunkCount();
+        });
+
+        Benchmark("StringBuilder::ToString + write (16MB concatenated)", 100, [response, devNull](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                String *str = response->ToString();
+                sink = (size_t)write(devNull, str->CString(), str->Length());
+                str->Release();
+            }
+        });
+
+        response->Release();
+        close(devNull);
+
+        Benchmark("Error::Create", 100000, [](size_t count)
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < count; i++)
+                total += strlen(Error::IndexError("Array", "ObjectAtIndex", i, 0).what());
+            sink = total;
+        });
+
+        String *text = new String();
+        for (size_t i = 0; i < 1024 * 1024 / 16; i++)
+            text->Append("Hello, World 123");
+
+        Benchmark("String::ConvertToUppercase/ConvertToLowercase (1MB)", 100, [text](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                text->ConvertToUppercase();
+                text->ConvertToLowercase();
+            }
+        });
+
+        Benchmark("String::Length (1MB)", 1000000, [text](size_t count)
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < count; i++)
+                total += text->Length();
+            sink = total;
+        });
+
+        text->Release();
+
+        // Loading a 64MB file of 64-byte lines
+
+        char path[] = "/tmp/ScoopMemoryBenchmark.XXXXXX";
+        int file = mkstemp(path);
+        std::vector<char> line(64, 'x');
+        line.back() = '\n';
+        for (size_t i = 0; i < 64 * 1024 * 1024 / line.size(); i++)
+            sink = write(file, line.data(), line.size());
+        close(file);
+
+        Benchmark("String::AssignFromFile (64MB)", 10, [&path](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                String *str = new String();
+                str->AssignFromFile(path);
+                sink = str->Length();
+                str->Release();
+            }
+        });
+
+        Benchmark("String::MapFromFile (64MB)", 10, [&path](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                String *str = new String();
+                str->MapFromFile(path);
+                sink = str->Length();
+                str->Release();
+            }
+        });
+
+        Benchmark("FileReader::ReadLine (64MB)", 10, [&path](size_t count)
+        {
+            String *str = new String();
+            for (size_t i = 0; i < count; i++)
+            {
+                FileReader *reader = new FileReader(path);
+                size_t lines = 0;
+                while (reader->ReadLine(str))
+                    lines++;
+                sink = lines;
+                reader->Release();
+            }
+            str->Release();
+        });
+
+        unlink(path);
+
+        // Hashing, computed each time and cached in the string
+
+        for (size_t length : { 16, 1024 })
+        {
+            char name[64];
+            String *str = new String();
+            for (size_t i = 0; i < length; i++)
+                str->Append((char)('a' + i % 26));
+
+            snprintf(name, sizeof(name), "String::Hash (%zu bytes, uncached)", length);
+            Benchmark(name, 1000000, [str](size_t count)
+            {
+                size_t hash = 0;
+                for (size_t i = 0; i < count; i++)
+                    hash += String::Hash(str->CString(), str->Length());
+                sink = hash;
+            });
+
+            snprintf(name, sizeof(name), "String::Hash (%zu bytes, cached)", length);
+            Benchmark(name, 1000000, [str](size_t count)
+            {
+                size_t hash = 0;
+                for (size_t i = 0; i < count; i++)
+                    hash += str->Hash();
+                sink = hash;
+            });
+
+            str->Release();
+        }
+
+        // Substrings of a tokenized line, copied into new strings and viewed in place, then looked up in a dictionary
+
+        String *tokens = new String();
+        for (size_t i = 0; i < 1000; i++)
+            tokens->AppendFormat("field%zu=%zu;", i % 100, i);
+
+        Dictionary *fields = new Dictionary();
+        for (size_t i = 0; i < 100; i++)
+        {
+            String *key = new String();
+            key->AssignFormat("field%zu", i);
+
+            Object *obj = new Object();
+            fields->SetObject(key, obj);
+            obj->Release();
+            key->Release();
+        }
+
+        Benchmark("String::String (substring, 1000 tokens)", 1000, [tokens, fields](size_t count)
+        {
+            size_t found = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                for (size_t start = 0, end; (end = tokens->Find("=", start)) != String::NotFound; start = tokens->Find(";", end) + 1)
+                {
+                    String *key = new String(tokens, start, end - start);
+                    found += fields->GetObjectIfPresent(key) != nullptr;
+                    key->Release();
+                }
+            }
+            sink = found;
+        });
+
+        Benchmark("StringView::StringView (1000 tokens)", 1000, [tokens, fields](size_t count)
+        {
+            size_t found = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                for (size_t start = 0, end; (end = tokens->Find("=", start)) != String::NotFound; start = tokens->Find(";", end) + 1)
+                {
+                    StringView key(tokens, start, end - start);
+                    found += fields->GetObjectIfPresent(key) != nullptr;
+                }
+            }
+            sink = found;
+        });
+
+        fields->Release();
+        tokens->Release();
+
+        // Memory footprint of short keys, which fit in the inline buffer, compared to keys that need a heap buffer
+
+        printf("[String footprint] sizeof(String) is %zu bytes.\n", sizeof(String));
+
+        const size_t keyCount = 100000;
+        const size_t keyLengths[] = { 8, 16, 22, 23, 32 };
+        std::vector<String *> keys(keyCount);
+
+        for (size_t keyLength : keyLengths)
+        {
+            size_t before = HeapUsage();
+            for (String *&key : keys)
+            {
+                key = new String();
+                key->AssignFormat("%0*zu", (int)keyLength, (size_t)(&key - keys.data()));
+            }
+            size_t after = HeapUsage();
+
+            if (after > before)
+                printf("[String footprint] %zu-byte keys: %.1f heap bytes/key.\n", keyLength, (double)(after - before) / keyCount);
+
+            for (String *key : keys)
+                key->Release();
+        }
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkStringKernels()
+    {
+        BEGIN_BENCHMARK("StringKernels");
+
+        using namespace StringKernels;
+        InstructionSet original = GetInstructionSet();
+
+        // Each kernel scans the whole buffer: the needle is missing, and the compared buffers differ only in case
+
+        const size_t lengths[] = { 1024, 64 * 1024, 1024 * 1024, 100 * 1024 * 1024 };
+        std::vector<char> data(lengths[3]), other(lengths[3]);
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            data[i] = (char)('a' + i % 26);
+            other[i] = (char)('A' + i % 26);
+        }
+
+        for (InstructionSet instructionSet : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2 })
+        {
+            if (!IsSupported(instructionSet))
+                continue;
+
+            SetInstructionSet(instructionSet);
+            const char *setName = InstructionSetName(instructionSet);
+
+            for (size_t length : lengths)
+            {
+                char name[96];
+                size_t iterations = 256 * 1024 * 1024 / length;
+
+                snprintf(name, sizeof(name), "StringKernels::Find (%s, %zu KB)", setName, length / 1024);
+                BenchmarkThroughput(name, iterations, length, [&data, length](size_t count)
+                {
+                    size_t found = 0;
+                    for (size_t i = 0; i < count; i++)
+                        found += Find(data.data(), length, "a-z", 3) != nullptr;
+                    sink = found;
+                });
+
+                snprintf(name, sizeof(name), "StringKernels::ConvertToUppercase (%s, %zu KB)", setName, length / 1024);
+                BenchmarkThroughput(name, iterations, length, [&data, length](size_t count)
+                {
+                    for (size_t i = 0; i < count; i++)
+                        ConvertToUppercase(data.data(), length);
+                    sink = (size_t)data[0];
+                });
+
+                snprintf(name, sizeof(name), "StringKernels::CompareIgnoringCase (%s, %zu KB)", setName, length / 1024);
+                BenchmarkThroughput(name, iterations, length, [&data, &other, length](size_t count)
+                {
+                    int result = 0;
+                    for (size_t i = 0; i < count; i++)
+                        result += CompareIgnoringCase(data.data(), other.data(), length);
+                    sink = (size_t)result;
+                });
+            }
+        }
+
+        SetInstructionSet(original);
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkArray()
+    {
+        BEGIN_BENCHMARK("Array");
+
+        const size_t size = 100000;
+        Array *source = new Array();
+        source->SetIndexed(true);
+
+        for (size_t i = 0; i < size; i++)
+        {
+            Object *object = new Object();
+            source->AddObject(object);
+            object->Release();
+        }
+
+        for (bool indexed : { false, true })
+        {
+            Array *array = new Array();
+            array->SetIndexed(indexed);
+
+            Benchmark(indexed ? "Array::AddObjects (100k objects, indexed)" : "Array::AddObjects (100k objects)", size, [array, source](size_t)
+            {
+                array->AddObjects(source);
+            });
+
+            Benchmark(indexed ? "Array::Contains (100k objects, indexed)" : "Array::Contains (100k objects)", 10000, [array, source](size_t count)
+            {
+                size_t found = 0;
+                for (size_t i = 0; i < count; i++)
+                    found += array->Contains(source->ObjectAtIndex((i * 7919) % size));
+                sink = found;
+            });
+
+            array->Release();
+        }
+
+        Benchmark("Array::RemoveObject (100k objects, indexed)", size, [source](size_t)
+        {
+            Array *array = new Array();
+            array->SetIndexed(true);
+            array->AddObjects(source);
+
+            for (size_t i = 0; i < size; i += 2)
+                array->RemoveObject(source->ObjectAtIndex(i));
+            for (size_t i = 1; i < size; i += 2)
+                array->RemoveObject(source->ObjectAtIndex(i));
+
+            sink = array->Count();
+            array->Release();
+        });
+
+        // Removing every other object
+
+        Array *half = new Array();
+        for (size_t i = 0; i < size; i += 2)
+            half->AddObject(source->ObjectAtIndex(i));
+
+        Benchmark("Array::RemoveObjects (50k of 100k objects)", size / 2, [source, half](size_t)
+        {
+            Array *array = new Array();
+            array->Copy(source);
+            array->RemoveObjects(half);
+            sink = array->Count();
+            array->Release();
+        });
+
+        Benchmark("Array::RemoveObjectAtIndexUnordered (100k objects)", size, [source](size_t count)
+        {
+            Array *array = new Array();
+            array->Copy(source);
+            for (size_t i = 0; i < count; i++)
+                array->RemoveObjectAtIndexUnordered(0);
+            sink = array->Count();
+            array->Release();
+        });
+
+        // Snapshots share storage, so only the first modification after one pays for a copy
+
+        Benchmark("Array::Snapshot (100k objects)", 1000000, [source](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                source->Snapshot()->Release();
+        });
+
+        Benchmark("Array::RemoveObjectAtIndexUnordered after Snapshot (100k objects)", 1000, [source](size_t count)
+        {
+            Array *array = new Array();
+            array->Copy(source);
+            for (size_t i = 0; i < count; i++)
+            {
+                Array *snapshot = array->Snapshot();
+                array->RemoveObjectAtIndexUnordered(0);
+                snapshot->Release();
+            }
+            sink = array->Count();
+            array->Release();
+        });
+
+        half->Release();
+        source->Release();
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkAutoreleasePool()
+    {
+        BEGIN_BENCHMARK("AutoreleasePool");
+
+        const size_t iterations = 1000000;
+
+        Benchmark("Object::Release (immediate)", iterations, [](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                String *str = new String();
+                str->Release();
+            }
+        });
+
+        Benchmark("Object::Autorelease (one pool per 1000 objects)", iterations, [](size_t count)
+        {
+            for (size_t i = 0; i < count; i += 1000)
+            {
+                AutoreleasePool pool;
+                for (size_t j = 0; j < 1000; j++)
+                    (new String())->Autorelease();
+            }
+        });
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkDictionary()
+    {
+        BEGIN_BENCHMARK("Dictionary");
+
+        const size_t iterations = 1000000;
+        char name[64];
+
+        for (size_t size = 10; size <= 1000000; size *= 10)
+        {
+            Dictionary *dict = new Dictionary();
+            std::vector<String *> keys;
+            Object *value = new Object();
+
+            for (size_t i = 0; i < size; i++)
+            {
+                String *key = new String();
+                key->AssignFormat("configuration.key.%zu", i);
+                dict->SetObject(key, value);
+                keys.push_back(key);
+            }
+
+            snprintf(name, sizeof(name), "Dictionary::GetObjectIfPresent (%zu keys)", size);
+            Benchmark(name, iterations, [dict, &keys, size](size_t count)
+            {
+                size_t found = 0;
+                for (size_t i = 0; i < count; i++)
+                    found += dict->GetObjectIfPresent(keys[(i * 7919) % size]) != nullptr;
+                sink = found;
+            });
+
+            snprintf(name, sizeof(name), "Dictionary::GetObjectIfPresent (const char *, %zu keys)", size);
+            Benchmark(name, iterations, [dict, &keys, size](size_t count)
+            {
+                size_t found = 0;
+                for (size_t i = 0; i < count; i++)
+                    found += dict->GetObjectIfPresent(keys[(i * 7919) % size]->CString()) != nullptr;
+                sink = found;
+            });
+
+            snprintf(name, sizeof(name), "Dictionary::Snapshot (%zu keys)", size);
+            Benchmark(name, iterations, [dict](size_t count)
+            {
+                for (size_t i = 0; i < count; i++)
+                    dict->Snapshot()->Release();
+            });
+
+            snprintf(name, sizeof(name), "Dictionary::SetObject after Snapshot (%zu keys)", size);
+            Benchmark(name, size < 100000 ? 10000 : 10, [dict, &keys, value, size](size_t count)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    Dictionary *snapshot = dict->Snapshot();
+                    dict->SetObject(keys[(i * 7919) % size], value);
+                    snapshot->Release();
+                }
+            });
+
+            for (String *key : keys)
+                key->Release();
+
+            value->Release();
+            dict->Release();
+        }
+
+        // Records that repeat the same field names, keyed by copies of the names and by one interned String per name
+
+        static const char *const fields[] = { "id", "name", "email", "created", "updated", "owner", "status", "tags" };
+        Object *value = new Object();
+
+        String *interned[8];
+        for (size_t i = 0; i < 8; i++)
+            interned[i] = StringTable::Shared().Intern(fields[i]);
+
+        Benchmark("Dictionary::SetObject (8 copied fields per new dictionary)", 100000, [value](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                Dictionary *record = new Dictionary();
+                for (const char *field : fields)
+                    record->SetObject(field, value);
+                record->Release();
+            }
+        });
+
+        Benchmark("Dictionary::SetObject (8 interned fields per new dictionary)", 100000, [value, &interned](size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                Dictionary *record = new Dictionary();
+                for (String *field : interned)
+                    record->SetObject(field, value);
+                record->Release();
+            }
+        });
+
+        Benchmark("StringTable::Intern (existing string)", iterations, [](size_t count)
+        {
+            size_t length = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                String *string = StringTable::Shared().Intern(fields[i % 8]);
+                length += string->Length();
+                string->Release();
+            }
+            sink = length;
+        });
+
+        for (String *field : interned)
+            field->Release();
+
+        value->Release();
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkPersistentDictionary()
+    {
+        BEGIN_BENCHMARK("PersistentDictionary");
+
+        char name[96];
+
+        for (size_t size = 100; size <= 100000; size *= 10)
+        {
+            Dictionary *dict = new Dictionary();
+            std::vector<String *> keys;
+            Object *value = new Object();
+
+            for (size_t i = 0; i < size; i++)
+            {
+                String *key = new String();
+                key->AssignFormat("configuration.key.%zu", i);
+                dict->SetObject(key, value);
+                keys.push_back(key);
+            }
+
+            PersistentDictionary *empty = new PersistentDictionary();
+            PersistentDictionary *persistent = empty->WithEntries(dict);
+            empty->Release();
+
+            // Deriving a version with one key changed, against a full copy of a mutable dictionary
+
+            const size_t iterations = size < 10000 ? 10000 : 100;
+
+            snprintf(name, sizeof(name), "Dictionary::Copy + SetObject (%zu keys)", size);
+            Benchmark(name, iterations, [dict, &keys, value, size](size_t count)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    Dictionary *version = new Dictionary();
+                    version->Copy(dict);
+                    version->SetObject(keys[(i * 7919) % size], value);
+                    version->Release();
+                }
+            });
+
+            snprintf(name, sizeof(name), "PersistentDictionary::With (%zu keys)", size);
+            Benchmark(name, iterations * 10, [persistent, &keys, size](size_t count)
+            {
+                Object *other = new Object();
+                for (size_t i = 0; i < count; i++)
+                    persistent->With(keys[(i * 7919) % size], other)->Release();
+                other->Release();
+            });
+
+            snprintf(name, sizeof(name), "PersistentDictionary::Without (%zu keys)", size);
+            Benchmark(name, iterations * 10, [persistent, &keys, size](size_t count)
+            {
+                for (size_t i = 0; i < count; i++)
+                    persistent->Without(keys[(i * 7919) % size])->Release();
+            });
+
+            snprintf(name, sizeof(name), "PersistentDictionary::GetObjectIfPresent (%zu keys)", size);
+            Benchmark(name, 1000000, [persistent, &keys, size](size_t count)
+            {
+                size_t found = 0;
+                for (size_t i = 0; i < count; i++)
+                    found += persistent->GetObjectIfPresent(keys[(i * 7919) % size]) != nullptr;
+                sink = found;
+            });
+
+            for (String *key : keys)
+                key->Release();
+
+            persistent->Release();
+            value->Release();
+            dict->Release();
+        }
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkAtomicProperty()
+    {
+        BEGIN_BENCHMARK("AtomicProperty");
+
+        const size_t iterations = 4000000;
+
+        // Readers load the current snapshot while a writer keeps publishing new ones
+
+        for (size_t threadCount : { 1, 2, 4, 8 })
+        {
+            AtomicProperty<Dictionary> current;
+            Property<Dictionary> locked;
+            std::mutex mutex;
+
+            ThreadSafe<Dictionary> *initial = new ThreadSafe<Dictionary>();
+            current = initial;
+            locked = initial;
+            initial->Release();
+
+            auto run = [threadCount](const char *name, auto load, auto store)
+            {
+                char label[96];
+                snprintf(label, sizeof(label), "%s (%zu readers)", name, threadCount);
+
+                Benchmark(label, iterations, [threadCount, load, store](size_t count)
+                {
+                    std::atomic<bool> stop { false };
+                    std::thread writer([&stop, store]()
+                    {
+                        while (!stop.load(std::memory_order_relaxed))
+                        {
+                            ThreadSafe<Dictionary> *snapshot = new ThreadSafe<Dictionary>();
+                            store(snapshot);
+                            snapshot->Release();
+                            std::this_thread::sleep_for(std::chrono::microseconds(100));
+                        }
+                    });
+
+                    std::vector<std::thread> readers;
+                    for (size_t t = 0; t < threadCount; t++)
+                    {
+                        readers.emplace_back([count, threadCount, load]()
+                        {
+                            for (size_t i = 0; i < count / threadCount; i++)
+                            {
+                                Dictionary *snapshot = load();
+                                sink = snapshot->Count();
+                                snapshot->Release();
+                            }
+                        });
+                    }
+
+                    for (std::thread &reader : readers)
+                        reader.join();
+
+                    stop = true;
+                    writer.join();
+                });
+            };
+
+            run("AtomicProperty::Load", [&current]() { return current.Load(); }, [&current](Dictionary *snapshot) { current = snapshot; });
+            run("Property::Get under a mutex", [&locked, &mutex]()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                Dictionary *snapshot = locked.Get();
+                snapshot->Retain();
+                return snapshot;
+            }, [&locked, &mutex](Dictionary *snapshot)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                locked = snapshot;
+            });
+        }
+
+        HazardPointers::Reclaim();
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkArena()
+    {
+        BEGIN_BENCHMARK("Arena");
+
+        const size_t iterations = 1000000;
+        const size_t batch = 1000;
+        const char *text = "a request-scoped string longer than the inline buffer";
+
+        // Build and tear down batches of strings with the same lifetime
+
+        std::vector<String *> strings(batch);
+        Benchmark("new String/Release (batch of 1000)", iterations, [&strings, text, batch](size_t count)
+        {
+            for (size_t i = 0; i < count; i += batch)
+            {
+                for (size_t j = 0; j < batch; j++)
+                    strings[j] = new String(text);
+
+                for (size_t j = 0; j < batch; j++)
+                    strings[j]->Release();
+            }
+        });
+
+        Benchmark("Arena::New<String>/~Arena (batch of 1000)", iterations, [&strings, text, batch](size_t count)
+        {
+            for (size_t i = 0; i < count; i += batch)
+            {
+                Arena arena;
+                for (size_t j = 0; j < batch; j++)
+                    strings[j] = arena.New<String>(text);
+
+                for (size_t j = 0; j < batch; j++)
+                    strings[j]->Release();
+            }
+        });
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkPoolAllocator()
+    {
+        BEGIN_BENCHMARK("PoolAllocator");
+
+        const size_t iterations = 10000000;
+        const size_t batch = 1000;
+        std::vector<void *> blocks(batch);
+
+        // Allocate and free batches of String-sized blocks
+
+        Benchmark("malloc/free (64 bytes)", iterations, [&blocks, batch](size_t count)
+        {
+            for (size_t i = 0; i < count; i += batch)
+            {
+                for (size_t j = 0; j < batch; j++)
+                    blocks[j] = malloc(sizeof(String));
+
+                for (size_t j = 0; j < batch; j++)
+                    free(blocks[j]);
+            }
+        });
+
+        Benchmark("PoolAllocator::Allocate/Deallocate (64 bytes)", iterations, [&blocks, batch](size_t count)
+        {
+            for (size_t i = 0; i < count; i += batch)
+            {
+                for (size_t j = 0; j < batch; j++)
+                    blocks[j] = PoolAllocator::Allocate(sizeof(String));
+
+                for (size_t j = 0; j < batch; j++)
+                    PoolAllocator::Deallocate(blocks[j], sizeof(String));
+            }
+        });
+
+        Benchmark("PoolAllocator::Allocate/Deallocate (64 bytes, 4 threads)", iterations, [batch](size_t count)
+        {
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < 4; t++)
+            {
+                threads.emplace_back([count, batch]()
+                {
+                    std::vector<void *> blocks(batch);
+                    for (size_t i = 0; i < count / 4; i += batch)
+                    {
+                        for (size_t j = 0; j < batch; j++)
+                            blocks[j] = PoolAllocator::Allocate(sizeof(String));
+
+                        for (size_t j = 0; j < batch; j++)
+                            PoolAllocator::Deallocate(blocks[j], sizeof(String));
+                    }
+                });
+            }
+
+            for (std::thread &thread : threads)
+                thread.join();
+        });
+
+#ifdef SCOOP_MEMORY_POOLED_ALLOCATION
+        const char *mode = "pooled";
+#else
+        const char *mode = "system";
+#endif
+
+        char name[64];
+        snprintf(name, sizeof(name), "new String/Release (%s)", mode);
+
+        std::vector<String *> strings(batch);
+        Benchmark(name, iterations, [&strings, batch](size_t count)
+        {
+            for (size_t i = 0; i < count; i += batch)
+            {
+                for (size_t j = 0; j < batch; j++)
+                    strings[j] = new String();
+
+                for (size_t j = 0; j < batch; j++)
+                    strings[j]->Release();
+            }
+        });
+
+        PoolAllocator::Statistics statistics = PoolAllocator::GetStatistics();
+        printf("[PoolAllocator::GetStatistics] %llu pooled allocations, %.1f%% hit rate, %llu slab bytes, %.1f%% fragmentation.\n",
+            (unsigned long long)statistics.allocations, statistics.HitRate() * 100.0, (unsigned long long)statistics.slabBytes, statistics.Fragmentation() * 100.0);
+
+        END_BENCHMARK;
+    }
+
+    void BenchmarkAll()
+    {
+        BenchmarkObject();
+        BenchmarkString();
+        BenchmarkStringKernels();
+        BenchmarkArray();
+        BenchmarkAutoreleasePool();
+        BenchmarkDictionary();
+        BenchmarkPersistentDictionary();
+        BenchmarkAtomicProperty();
+        BenchmarkArena();
+        BenchmarkPoolAllocator();
+    }
+}
\ No newline at end of file
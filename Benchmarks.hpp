@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Scoop::Memory::BenchmarkScoopMemory
+{
+    void BenchmarkObject();
+    void BenchmarkString();
+    void BenchmarkStringKernels();
+    void BenchmarkArray();
+    void BenchmarkAutoreleasePool();
+    void BenchmarkDictionary();
+    void BenchmarkPersistentDictionary();
+    void BenchmarkAtomicProperty();
+    void BenchmarkArena();
+    void BenchmarkPoolAllocator();
+
+    void BenchmarkAll();
+}
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "CycleCollector.hpp"
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Scoop::Memory
+{
+    // Candidate roots: containers whose reference count was decremented without freeing them
+
+    struct CandidateBuffer
+    {
+        std::mutex mutex;
+        std::unordered_set<Object *> candidates;
+        std::unordered_set<Object *> deferred;
+        size_t threshold = 0;
+        size_t stepBudget = 10000;
+    };
+
+    static CandidateBuffer &Buffer()
+    {
+        static CandidateBuffer *buffer = new CandidateBuffer();
+        return *buffer;
+    }
+
+    // Enable candidate tracking
+
+    void CycleCollector::SetEnabled(bool enable)
+    {
+        enabled.store(enable, std::memory_order_relaxed);
+
+        if (!enable)
+        {
+            CandidateBuffer &buffer = Buffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+
+            for (Object *obj : buffer.candidates)
+                obj->collectorCandidate.store(false, std::memory_order_relaxed);
+            for (Object *obj : buffer.deferred)
+                obj->collectorCandidate.store(false, std::memory_order_relaxed);
+
+            buffer.candidates.clear();
+            buffer.deferred.clear();
+        }
+    }
+
+    // Automatic collection
+
+    size_t CycleCollector::GetThreshold()
+    {
+        CandidateBuffer &buffer = Buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        return buffer.threshold;
+    }
+
+    void CycleCollector::SetThreshold(size_t threshold)
+    {
+        CandidateBuffer &buffer = Buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.threshold = threshold;
+    }
+
+    size_t CycleCollector::GetStepBudget()
+    {
+        CandidateBuffer &buffer = Buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        return buffer.stepBudget;
+    }
+
+    void CycleCollector::SetStepBudget(size_t budget)
+    {
+        CandidateBuffer &buffer = Buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.stepBudget = budget;
+    }
+
+    void CycleCollector::Poll()
+    {
+        if (!IsEnabled())
+            return;
+
+        size_t threshold = GetThreshold();
+        if (threshold != 0 && CandidateCount() >= threshold)
+            Step(GetStepBudget());
+    }
+
+    // Candidates
+
+    size_t CycleCollector::CandidateCount()
+    {
+        CandidateBuffer &buffer = Buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        return buffer.candidates.size();
+    }
+
+    size_t CycleCollector::DeferredCount()
+    {
+        CandidateBuffer &buffer = Buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        return buffer.deferred.size();
+    }
+
+    void CycleCollector::AddCandidate(Object *obj)
+    {
+        // Objects with atomic reference counts may be released and freed by other threads at any time, so they are never examined
+
+        if (obj->atomicReferenceCount || obj->collectorCandidate.load(std::memory_order_relaxed) || !obj->HasChildren())
+            return;
+
+        CandidateBuffer &buffer = Buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+
+        if (buffer.candidates.insert(obj).second)
+            obj->collectorCandidate.store(true, std::memory_order_relaxed);
+    }
+
+    void CycleCollector::RemoveCandidate(Object *obj)
+    {
+        CandidateBuffer &buffer = Buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+
+        buffer.candidates.erase(obj);
+        buffer.deferred.erase(obj);
+        obj->collectorCandidate.store(false, std::memory_order_relaxed);
+    }
+
+    // Collection
+
+    bool CycleCollector::CollectRoot(Object *root, size_t budget, size_t *visited, size_t *collected)
+    {
+        struct Node
+        {
+            long count;
+            bool live;
+        };
+
+        // Gather every object reachable from the root, starting from its reference count; gathering changes nothing, so it is
+        // abandoned once more than budget objects are found, and every later phase is bounded by the objects gathered.
+        // Objects with atomic reference counts are left out, so the references they hold keep the objects they reach alive
+
+        std::unordered_map<Object *, Node> nodes;
+        std::vector<Object *> order;
+        std::vector<Object *> stack { root };
+
+        while (!stack.empty())
+        {
+            Object *obj = stack.back();
+            stack.pop_back();
+
+            if (!nodes.emplace(obj, Node { (long)obj->GetReferenceCount(), false }).second)
+                continue;
+
+            if (order.size() == budget)
+            {
+                *visited = budget;
+                return false;
+            }
+
+            order.push_back(obj);
+            obj->EnumerateChildren([](Object *child, void *context)
+            {
+                if (!child->atomicReferenceCount)
+                    ((std::vector<Object *> *)context)->push_back(child);
+            }, &stack);
+        }
+
+        *visited = order.size();
+
+        // Subtract references from inside the subgraph; whatever remains comes from outside it
+
+        for (Object *obj : order)
+        {
+            obj->EnumerateChildren([](Object *child, void *context)
+            {
+                auto *nodes = (std::unordered_map<Object *, Node> *)context;
+                auto node = nodes->find(child);
+                if (node != nodes->end())
+                    node->second.count--;
+            }, &nodes);
+        }
+
+        for (Object *obj : order)
+        {
+            if (nodes[obj].count > 0)
+                stack.push_back(obj);
+        }
+
+        // Anything reachable from an externally referenced object is live
+
+        struct MarkContext
+        {
+            std::unordered_map<Object *, Node> *nodes;
+            std::vector<Object *> *stack;
+        } context { &nodes, &stack };
+
+        while (!stack.empty())
+        {
+            Object *obj = stack.back();
+            stack.pop_back();
+
+            Node &node = nodes[obj];
+            if (node.live)
+                continue;
+
+            node.live = true;
+            obj->EnumerateChildren([](Object *child, void *context)
+            {
+                MarkContext *mark = (MarkContext *)context;
+                auto node = mark->nodes->find(child);
+                if (node != mark->nodes->end() && !node->second.live)
+                    mark->stack->push_back(child);
+            }, &context);
+        }
+
+        std::vector<Object *> garbage;
+        for (Object *obj : order)
+        {
+            if (!nodes[obj].live)
+                garbage.push_back(obj);
+        }
+
+        // Keep the garbage alive while its cycles are broken, then free it
+
+        for (Object *obj : garbage)
+            obj->Retain();
+
+        for (Object *obj : garbage)
+            obj->ClearChildren();
+
+        for (Object *obj : garbage)
+            obj->Release();
+
+        *collected = garbage.size();
+        return true;
+    }
+
+    size_t CycleCollector::Step(size_t maxObjects)
+    {
+        // Roots are examined one at a time until maxObjects objects have been visited; a root that could not fit in a
+        // whole step is deferred to Collect, and one that only did not fit in what was left waits for the next step
+
+        CandidateBuffer &buffer = Buffer();
+        size_t remaining = maxObjects, collected = 0;
+
+        while (remaining != 0)
+        {
+            Object *root;
+            {
+                std::lock_guard<std::mutex> lock(buffer.mutex);
+                if (buffer.candidates.empty())
+                    break;
+
+                auto iterator = buffer.candidates.begin();
+                root = *iterator;
+                buffer.candidates.erase(iterator);
+                root->collectorCandidate.store(false, std::memory_order_relaxed);
+            }
+
+            size_t visited, freed;
+            if (CollectRoot(root, remaining, &visited, &freed))
+            {
+                collected += freed;
+                remaining -= visited;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            if (remaining == maxObjects)
+                buffer.deferred.insert(root);
+            else
+                buffer.candidates.insert(root);
+
+            root->collectorCandidate.store(true, std::memory_order_relaxed);
+            break;
+        }
+
+        return collected;
+    }
+
+    size_t CycleCollector::Collect()
+    {
+        {
+            CandidateBuffer &buffer = Buffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+
+            buffer.candidates.insert(buffer.deferred.begin(), buffer.deferred.end());
+            buffer.deferred.clear();
+        }
+
+        size_t collected = 0;
+        while (CandidateCount() != 0)
+            collected += Step((size_t)-1);
+
+        return collected;
+    }
+}
\ No newline at end of file
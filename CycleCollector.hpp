@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+namespace Scoop::Memory
+{
+    class CycleCollector
+    {
+        private:
+            static inline std::atomic<bool> enabled { false };
+
+            static bool CollectRoot(Object *root, size_t budget, size_t *visited, size_t *collected);
+
+        public:
+            // Enable candidate tracking
+
+            static bool IsEnabled()
+            { return enabled.load(std::memory_order_relaxed); }
+
+            static void SetEnabled(bool enable);
+
+            // Automatic collection
+
+            static size_t GetThreshold();
+            static void SetThreshold(size_t threshold);
+
+            static size_t GetStepBudget();
+            static void SetStepBudget(size_t budget);
+
+            static void Poll();
+
+            // Candidates; roots whose reachable objects exceed a step's budget are deferred to Collect
+
+            static size_t CandidateCount();
+            static size_t DeferredCount();
+
+            static void AddCandidate(Object *obj);
+            static void RemoveCandidate(Object *obj);
+
+            // Collection
+
+            static size_t Step(size_t maxObjects);
+            static size_t Collect();
+
+            // Prohibit construction
+
+            CycleCollector() = delete;
+    };
+}
\ No newline at end of file
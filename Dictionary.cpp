@@ -2,11 +2,16 @@
 
 #include <cstring>
 
-static void AssertValidKey(const char *key, const char *methodName)
+static std::string_view KeyView(const char *key, const char *methodName)
 {
     if (key == nullptr)
         throw Error::NullError("Dictionary", methodName, "key");
-    if (strlen(key) == 0)
+    return std::string_view(key);
+}
+
+static void AssertValidKey(std::string_view key, const char *methodName)
+{
+    if (key.empty())
         throw Error::EmptyError("Dictionary", methodName, "key");
 }
 
@@ -20,33 +25,200 @@ static void AssertValidKey(const String *key, const char *methodName)
 
 namespace Scoop::Memory
 {
-    Dictionary::~Dictionary()
-    { this->Clear(); }
+    Dictionary::~Dictionary() = default;
 
-    // Copy other dictionary
+    // Storage
 
-    void Dictionary::Copy(const Dictionary *other)
+    Dictionary::Storage::~Storage()
     {
-        this->map = other->map;
+        for (const Entry &entry : this->entries)
+        {
+            if (entry.key != nullptr)
+            {
+                entry.key->Release();
+                entry.value->Release();
+            }
+        }
+    }
 
-        for (const auto &pair : this->map)
+    bool Dictionary::FindIndex(const char *key, size_t length, size_t hash, size_t *index, const String *keyObject) const
+    { return this->storage != nullptr && this->storage->FindIndex(key, length, hash, index, keyObject); }
+
+    Dictionary::Storage &Dictionary::MutableStorage(const char *methodName)
+    {
+        if (this->frozen)
+            throw Error::Create("Dictionary", methodName, "Dictionary is frozen.");
+
+        if (this->storage == nullptr)
+            this->storage = std::make_shared<Storage>();
+        else if (this->storage.use_count() > 1)
         {
-            pair.first->Retain();
-            pair.second->Retain();
+            // Copy on write: the new storage holds its own reference to each key and value
+
+            std::shared_ptr<Storage> copy = std::make_shared<Storage>();
+            copy->entries = this->storage->entries;
+            copy->count = this->storage->count;
+
+            for (const Entry &entry : copy->entries)
+            {
+                if (entry.key != nullptr)
+                {
+                    entry.key->Retain();
+                    entry.value->Retain();
+                }
+            }
+
+            this->storage = copy;
         }
+
+        return *this->storage;
     }
 
-    // Clear dictionary
+    // Hash table
 
-    void Dictionary::Clear()
+    bool Dictionary::Storage::FindIndex(const char *key, size_t length, size_t hash, size_t *index, const String *keyObject) const
     {
-        for (const auto &pair : this->map)
+        size_t capacity = this->entries.size();
+        if (capacity == 0)
+            return false;
+
+        size_t mask = capacity - 1;
+        for (size_t i = hash & mask; ; i = (i + 1) & mask)
         {
-            pair.first->Release();
-            pair.second->Release();
+            const Entry &entry = this->entries[i];
+            if (entry.key == nullptr)
+                return false;
+
+            // Keys are usually interned, so the same key object is found without comparing bytes
+
+            if (entry.key == keyObject || (entry.hash == hash && entry.key->Length() == length && memcmp(entry.key->CString(), key, length) == 0))
+            {
+                *index = i;
+                return true;
+            }
         }
+    }
 
-        this->map.clear();
+    void Dictionary::Storage::InsertEntry(String *key, Object *value, size_t hash)
+    {
+        // Keep the load factor at or below 3/4
+
+        if ((this->count + 1) * 4 > this->entries.size() * 3)
+            this->Grow();
+
+        size_t mask = this->entries.size() - 1;
+        size_t i = hash & mask;
+        while (this->entries[i].key != nullptr)
+            i = (i + 1) & mask;
+
+        this->entries[i] = { key, value, hash };
+        this->count++;
+    }
+
+    void Dictionary::Storage::RemoveEntryAtIndex(size_t index)
+    {
+        // Shift following entries back so that probe sequences stay unbroken
+
+        size_t mask = this->entries.size() - 1;
+        size_t i = index;
+
+        for (size_t j = (i + 1) & mask; this->entries[j].key != nullptr; j = (j + 1) & mask)
+        {
+            size_t ideal = this->entries[j].hash & mask;
+            if (((j - i) & mask) <= ((j - ideal) & mask))
+            {
+                this->entries[i] = this->entries[j];
+                i = j;
+            }
+        }
+
+        this->entries[i] = { nullptr, nullptr, 0 };
+        this->count--;
+    }
+
+    void Dictionary::Storage::Grow()
+    {
+        size_t capacity = this->entries.empty() ? 8 : this->entries.size() * 2;
+
+        std::vector<Entry> old(capacity, Entry { nullptr, nullptr, 0 });
+        old.swap(this->entries);
+        this->count = 0;
+
+        for (const Entry &entry : old)
+        {
+            if (entry.key != nullptr)
+                this->InsertEntry(entry.key, entry.value, entry.hash);
+        }
+    }
+
+    // Cycle collection
+
+    bool Dictionary::HasChildren() const
+    { return true; }
+
+    void Dictionary::EnumerateChildren(ChildVisitor visitor, void *context) const
+    {
+        // Keys are strings, which cannot take part in a cycle. Shared storage holds one reference per value for all of its owners, so only unshared storage is traversed
+
+        if (this->storage == nullptr || this->storage.use_count() > 1)
+            return;
+
+        for (const Entry &entry : this->storage->entries)
+        {
+            if (entry.key != nullptr)
+                visitor(entry.value, context);
+        }
+    }
+
+    void Dictionary::ClearChildren()
+    { std::shared_ptr<Storage> old = std::move(this->storage); }
+
+    // Copy other dictionary
+
+    void Dictionary::Copy(const Dictionary *other)
+    {
+        if (other == this)
+            return;
+
+        if (this->frozen)
+            throw Error::Create("Dictionary", "Copy", "Dictionary is frozen.");
+
+        std::shared_ptr<Storage> old = std::move(this->storage);
+        this->storage = other->storage;
+    }
+
+    // Immutability
+
+    bool Dictionary::IsFrozen() const
+    { return this->frozen; }
+
+    void Dictionary::Freeze()
+    { this->frozen = true; }
+
+    Dictionary *Dictionary::Snapshot() const
+    {
+        Dictionary *snapshot = new Dictionary();
+        snapshot->storage = this->storage;
+        snapshot->frozen = true;
+
+        return snapshot;
+    }
+
+    // Entry count
+
+    size_t Dictionary::Count() const
+    { return this->storage != nullptr ? this->storage->count : 0; }
+
+    // Clear dictionary
+
+    void Dictionary::Clear()
+    {
+        if (this->frozen)
+            throw Error::Create("Dictionary", "Clear", "Dictionary is frozen.");
+
+        // Entries are released once the storage is detached, so a destructor that reaches this dictionary sees it empty
+
+        std::shared_ptr<Storage> old = std::move(this->storage);
     }
 
     // Get all keys
@@ -58,10 +230,24 @@ namespace Scoop::Memory
 
         keys->Clear();
 
-        for (const auto &pair : this->map)
+        if (this->storage == nullptr)
+            return;
+
+        for (const Entry &entry : this->storage->entries)
         {
+            if (entry.key == nullptr)
+                continue;
+
+            // Interned keys cannot change, so they are shared rather than copied
+
+            if (entry.key->IsInterned())
+            {
+                keys->AddObject(entry.key);
+                continue;
+            }
+
             String *key = new String();
-            key->Assign(pair.first);
+            key->Assign(entry.key);
             keys->AddObject(key);
             key->Release();
         }
@@ -70,116 +256,169 @@ namespace Scoop::Memory
     // Check if dictionary contains key
 
     bool Dictionary::Contains(const char *key) const
+    { return this->Contains(KeyView(key, "Contains")); }
+
+    bool Dictionary::Contains(std::string_view key) const
     {
         AssertValidKey(key, "Contains");
 
-        for (const auto &pair : this->map)
-        {
-            if (pair.first->IsEqual(key))
-                return true;
-        }
-
-        return false;
+        size_t index;
+        return this->FindIndex(key.data(), key.size(), String::Hash(key.data(), key.size()), &index);
     }
 
     bool Dictionary::Contains(const String *key) const
     {
         AssertValidKey(key, "Contains");
 
-        for (const auto &pair : this->map)
-        {
-            if (pair.first->IsEqual(key))
-                return true;
-        }
-
-        return false;
+        size_t index;
+        return this->FindIndex(key->CString(), key->Length(), key->Hash(), &index, key);
     }
 
+    // Assign entry
+
     void Dictionary::SetObject(const char *key, Object *value)
+    { this->SetObject(KeyView(key, "SetObject"), value); }
+
+    void Dictionary::SetObject(std::string_view key, Object *value)
     {
-        String *str = new String(key);
-        this->SetObject(str, value);
-        str->Release();
+        AssertValidKey(key, "SetObject");
+
+        if (value == nullptr)
+            throw Error::NullError("Dictionary", "SetObject", "value");
+
+        Storage &storage = this->MutableStorage("SetObject");
+        value->Retain();
+
+        // Replacing the value of an existing key keeps its key object, so no String is allocated
+
+        size_t index, hash = String::Hash(key.data(), key.size());
+        if (storage.FindIndex(key.data(), key.size(), hash, &index))
+        {
+            Object *previous = storage.entries[index].value;
+            storage.entries[index].value = value;
+            previous->Release();
+        }
+        else
+        {
+            String *str = new String();
+            str->AssignData(key.data(), key.size());
+            storage.InsertEntry(str, value, hash);
+        }
     }
 
     void Dictionary::SetObject(String *key, Object *value)
     {
         AssertValidKey(key, "SetObject");
 
+        // Only an interned key is shared, since it cannot change; any other key is copied, as the caller may modify it
+
+        if (!key->IsInterned())
+        {
+            this->SetObject(std::string_view(key->CString(), key->Length()), value);
+            return;
+        }
+
         if (value == nullptr)
             throw Error::NullError("Dictionary", "SetObject", "value");
 
+        Storage &storage = this->MutableStorage("SetObject");
         key->Retain();
         value->Retain();
 
-        this->Remove(key);
-        this->map.insert_or_assign(key, value);
+        size_t index, length = key->Length();
+        size_t hash = key->Hash();
+
+        if (storage.FindIndex(key->CString(), length, hash, &index, key))
+        {
+            Entry previous = storage.entries[index];
+            storage.entries[index] = { key, value, hash };
+
+            previous.key->Release();
+            previous.value->Release();
+        }
+        else
+            storage.InsertEntry(key, value, hash);
     }
 
+    // Retrieve entry
+
     Object *Dictionary::GetObject(const char *key) const
+    { return this->GetObject(KeyView(key, "GetObject")); }
+
+    Object *Dictionary::GetObject(std::string_view key) const
     {
-        String *str = new String(key);
-        Object *value = this->GetObject(str);
-        str->Release();
+        Object *object = this->GetObjectIfPresent(key);
+
+        if (object == nullptr)
+            throw Error::Create("Dictionary", "GetObject", "Dictionary does not contain specified key '%.*s'.", (int)key.size(), key.data());
 
-        return value;
+        return object;
     }
 
     Object *Dictionary::GetObject(const String *key) const
     {
+        AssertValidKey(key, "GetObject");
+
         Object *object = this->GetObjectIfPresent(key);
 
         if (object == nullptr)
-            throw Error::Create("Dictionary", "GetObject", "Dictionary does not contain specified key '%s'.", key->CString());
+            throw Error::Create("Dictionary", "GetObject", "Dictionary does not contain specified key '%.*s'.", (int)key->Length(), key->CString());
 
         return object;
     }
 
     Object *Dictionary::GetObjectIfPresent(const char *key) const
+    { return this->GetObjectIfPresent(KeyView(key, "GetObjectIfPresent")); }
+
+    Object *Dictionary::GetObjectIfPresent(std::string_view key) const
     {
-        String *str = new String(key);
-        Object *value = this->GetObjectIfPresent(str);
-        str->Release();
+        AssertValidKey(key, "GetObjectIfPresent");
 
-        return value;
+        size_t index;
+        if (this->FindIndex(key.data(), key.size(), String::Hash(key.data(), key.size()), &index))
+            return this->storage->entries[index].value;
+
+        return nullptr;
     }
 
     Object *Dictionary::GetObjectIfPresent(const String *key) const
     {
         AssertValidKey(key, "GetObjectIfPresent");
 
-        for (const auto &pair : this->map)
-        {
-            if (pair.first->IsEqual(key))
-                return pair.second;
-        }
+        size_t index;
+        if (this->FindIndex(key->CString(), key->Length(), key->Hash(), &index, key))
+            return this->storage->entries[index].value;
 
         return nullptr;
     }
 
+    // Remove entry
+
     void Dictionary::Remove(const char *key)
-    {
-        String *str = new String(key);
-        this->Remove(str);
-        str->Release();
-    }
+    { this->Remove(KeyView(key, "Remove")); }
 
-    void Dictionary::Remove(String *keyToRemove)
+    void Dictionary::Remove(std::string_view key)
     {
-        AssertValidKey(keyToRemove, "Remove");
+        AssertValidKey(key, "Remove");
 
-        for (auto it = this->map.begin(); it != this->map.end(); it++)
-        {
-            String *key = it->first;
+        if (this->frozen)
+            throw Error::Create("Dictionary", "Remove", "Dictionary is frozen.");
 
-            if (key->IsEqual(keyToRemove))
-            {
-                it->second->Release();
-                this->map.erase(key);
-                key->Release();
+        size_t index;
+        if (!this->FindIndex(key.data(), key.size(), String::Hash(key.data(), key.size()), &index))
+            return;
 
-                return;
-            }
-        }
+        Storage &storage = this->MutableStorage("Remove");
+        Entry entry = storage.entries[index];
+        storage.RemoveEntryAtIndex(index);
+
+        entry.key->Release();
+        entry.value->Release();
+    }
+
+    void Dictionary::Remove(String *key)
+    {
+        AssertValidKey(key, "Remove");
+        this->Remove(std::string_view(key->CString(), key->Length()));
     }
 }
\ No newline at end of file
@@ -1,22 +1,72 @@
 #pragma once
 
-#include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
 
 namespace Scoop::Memory
 {
+    class PersistentDictionary;
+
     class Dictionary : public Object
     {
+        friend class PersistentDictionary;
+
         private:
-            std::map<String *, Object *> map;
+            struct Entry
+            {
+                String *key;
+                Object *value;
+                size_t hash;
+            };
+
+            // Open-addressing table with linear probing; empty slots have a null key
+
+            struct Storage
+            {
+                std::vector<Entry> entries;
+                size_t count = 0;
+
+                ~Storage();
+
+                bool FindIndex(const char *key, size_t length, size_t hash, size_t *index, const String *keyObject = nullptr) const;
+                void InsertEntry(String *key, Object *value, size_t hash);
+                void RemoveEntryAtIndex(size_t index);
+                void Grow();
+            };
+
+            // Storage is shared between copies and snapshots, and copied before a shared storage is modified
+
+            std::shared_ptr<Storage> storage;
+            bool frozen = false;
+
+            bool FindIndex(const char *key, size_t length, size_t hash, size_t *index, const String *keyObject = nullptr) const;
+            Storage &MutableStorage(const char *methodName);
 
         public:
             Dictionary() = default;
             ~Dictionary();
 
-            // Copy
+            // Cycle collection
+
+            bool HasChildren() const override;
+            void EnumerateChildren(ChildVisitor visitor, void *context) const override;
+            void ClearChildren() override;
+
+            // Copy other dictionary, sharing its storage until either is modified
 
             void Copy(const Dictionary *other);
 
+            // Immutability
+
+            bool IsFrozen() const;
+            void Freeze();
+            Dictionary *Snapshot() const;
+
+            // Entry count
+
+            size_t Count() const;
+
             // Clear dictionary
             
             void Clear();
@@ -25,22 +75,29 @@ namespace Scoop::Memory
 
             void GetAllKeys(Array *keys) const;
 
+            // Every method taking a key accepts a null-terminated const char *, a String, or a std::string_view, which is the
+            // pointer-and-length form for keys that are not null-terminated: std::string_view(pointer, length)
+
             // Check if dictionary contains a key
 
             bool Contains(const char *key) const;
+            bool Contains(std::string_view key) const;
             bool Contains(const String *key) const;
 
             // Assign entry
 
             void SetObject(const char *key, Object *value);
+            void SetObject(std::string_view key, Object *value);
             void SetObject(String *key, Object *value);
 
             // Retrieve entry
 
             Object *GetObject(const char *key) const;
+            Object *GetObject(std::string_view key) const;
             Object *GetObject(const String *key) const;
 
             Object *GetObjectIfPresent(const char *key) const;
+            Object *GetObjectIfPresent(std::string_view key) const;
             Object *GetObjectIfPresent(const String *key) const;
 
             template <class T> T *GetObject(const char *key) const
@@ -49,6 +106,12 @@ namespace Scoop::Memory
                 return static_cast<T *>(object);
             }
 
+            template <class T> T *GetObject(std::string_view key) const
+            {
+                Object *object = this->GetObject(key);
+                return static_cast<T *>(object);
+            }
+
             template <class T> T *GetObject(const String *key) const
             {
                 Object *object = this->GetObject(key);
@@ -61,6 +124,12 @@ namespace Scoop::Memory
                 return static_cast<T *>(object);
             }
 
+            template <class T> T *GetObjectIfPresent(std::string_view key) const
+            {
+                Object *object = this->GetObjectIfPresent(key);
+                return static_cast<T *>(object);
+            }
+
             template <class T> T *GetObjectIfPresent(const String *key) const
             {
                 Object *object = this->GetObjectIfPresent(key);
@@ -70,6 +139,7 @@ namespace Scoop::Memory
             // Remove entry
 
             void Remove(const char *key);
+            void Remove(std::string_view key);
             void Remove(String *key);
     };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstring>
 #include <stdexcept>
 
 namespace Scoop::Memory::Error
@@ -7,7 +8,10 @@ namespace Scoop::Memory::Error
     template <typename ... Args>
     static std::runtime_error Create(const char *className, const char *methodName, const char *format, Args ... args)
     {
+        // Reserve enough for a typical message up front, so that formatting rarely has to grow the string
+
         String *str = new String();
+        str->Reserve(strlen(className) + strlen(methodName) + strlen(format) + 64);
         str->AssignFormat("[%s::%s] ", className, methodName);
         str->AppendFormat(format, args ...);
 
@@ -0,0 +1,108 @@
+#include "FileReader.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace Scoop::Memory
+{
+    FileReader::FileReader(const char *path, size_t bufferSize) : bufferSize(bufferSize)
+    {
+        if (path == nullptr)
+            throw Error::NullError("FileReader", "FileReader", "path");
+        if (bufferSize == 0)
+            throw Error::Create("FileReader", "FileReader", "Buffer size may not be 0.");
+
+        this->file = fopen(path, "rb");
+        if (this->file == nullptr)
+            throw Error::Create("FileReader", "FileReader", "Failed to open file '%s': %s.", path, strerror(errno));
+
+        this->buffer = (char *)malloc(bufferSize);
+    }
+
+    FileReader::FileReader(const String *path, size_t bufferSize) : FileReader(path == nullptr ? nullptr : path->CString(), bufferSize)
+    { }
+
+    FileReader::~FileReader()
+    {
+        fclose(this->file);
+        free(this->buffer);
+    }
+
+    // Refill buffer
+
+    bool FileReader::Fill(const char *methodName)
+    {
+        this->position = 0;
+        this->end = fread(this->buffer, 1, this->bufferSize, this->file);
+
+        if (this->end == 0 && ferror(this->file))
+            throw Error::Create("FileReader", methodName, "Failed to read file: %s.", strerror(errno));
+
+        return this->end != 0;
+    }
+
+    // End of file
+
+    bool FileReader::AtEnd()
+    { return this->position == this->end && !this->Fill("AtEnd"); }
+
+    // Read from file
+
+    bool FileReader::ReadLine(String *line)
+    {
+        if (line == nullptr)
+            throw Error::NullError("FileReader", "ReadLine", "line");
+
+        line->Clear();
+
+        bool read = false;
+        while (this->position < this->end || this->Fill("ReadLine"))
+        {
+            read = true;
+
+            const char *start = this->buffer + this->position;
+            const char *newline = (const char *)memchr(start, '\n', this->end - this->position);
+
+            if (newline == nullptr)
+            {
+                line->AppendData(start, this->end - this->position);
+                this->position = this->end;
+                continue;
+            }
+
+            line->AppendData(start, newline - start);
+            this->position += newline - start + 1;
+            break;
+        }
+
+        // Accept Windows line endings
+
+        size_t length = line->Length();
+        if (length != 0 && line->CString()[length - 1] == '\r')
+            line->AssignData(line->CString(), length - 1);
+
+        return read;
+    }
+
+    bool FileReader::ReadBlock(String *block, size_t size)
+    {
+        if (block == nullptr)
+            throw Error::NullError("FileReader", "ReadBlock", "block");
+
+        block->Clear();
+        block->Reserve(size);
+
+        while (block->Length() < size && (this->position < this->end || this->Fill("ReadBlock")))
+        {
+            size_t count = this->end - this->position;
+            if (count > size - block->Length())
+                count = size - block->Length();
+
+            block->AppendData(this->buffer + this->position, count);
+            this->position += count;
+        }
+
+        return !block->Empty();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdio>
+
+namespace Scoop::Memory
+{
+    class FileReader : public Object
+    {
+        private:
+            FILE *file = nullptr;
+            char *buffer = nullptr;
+            size_t bufferSize;
+            size_t position = 0;
+            size_t end = 0;
+
+            bool Fill(const char *methodName);
+
+        public:
+            explicit FileReader(const char *path, size_t bufferSize = 64 * 1024);
+            explicit FileReader(const String *path, size_t bufferSize = 64 * 1024);
+            ~FileReader();
+
+            // End of file
+
+            bool AtEnd();
+
+            // Read from file
+
+            bool ReadLine(String *line);
+            bool ReadBlock(String *block, size_t size);
+    };
+}
\ No newline at end of file
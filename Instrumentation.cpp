@@ -0,0 +1,376 @@
+#include "Instrumentation.hpp"
+
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#endif
+
+namespace Scoop::Memory
+{
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+    struct HistoryEvent
+    {
+        enum class Kind
+        {
+            Retain,
+            Release,
+            Destroyed
+        } kind;
+
+        unsigned int count;
+        void *callSite;
+    };
+
+    struct History
+    {
+        const void *address;
+        std::string typeName;
+        std::vector<HistoryEvent> events;
+    };
+
+    // Types are resolved lazily, since an object's dynamic type is unknown while its base constructor runs
+
+    struct ObjectRecord
+    {
+        void *callSite;
+        const std::type_info *type;
+        History *history;
+    };
+
+    struct TypeRecord
+    {
+        std::string name;
+        size_t live = 0;
+        size_t peak = 0;
+        size_t total = 0;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::unordered_map<const Object *, ObjectRecord> objects;
+        std::unordered_map<std::type_index, TypeRecord> types;
+        std::vector<History *> histories;
+        size_t peak = 0;
+    };
+
+    static Registry &GetRegistry()
+    {
+        static Registry *registry = new Registry();
+        return *registry;
+    }
+
+    static thread_local void *allocationCallSite = nullptr;
+
+    static std::string TypeName(const std::type_info &type)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        if (demangled != nullptr)
+        {
+            std::string name(demangled);
+            free(demangled);
+            return name;
+        }
+#endif
+        return type.name();
+    }
+
+    static void Resolve(Registry &registry, const Object *obj, ObjectRecord &record)
+    {
+        // Re-resolving corrects a type that was observed while a subclass constructor was still running
+
+        const std::type_info *resolved = &typeid(*obj);
+        if (record.type != nullptr && *record.type == *resolved)
+            return;
+
+        if (record.type != nullptr)
+        {
+            TypeRecord &previous = registry.types[std::type_index(*record.type)];
+            previous.live--;
+            previous.total--;
+        }
+
+        record.type = resolved;
+
+        TypeRecord &type = registry.types[std::type_index(*resolved)];
+        if (type.name.empty())
+            type.name = TypeName(*resolved);
+
+        type.total++;
+        if (++type.live > type.peak)
+            type.peak = type.live;
+
+        if (record.history != nullptr)
+            record.history->typeName = type.name;
+    }
+
+    static void PrintCallSite(FILE *file, void *callSite)
+    {
+        if (callSite == nullptr)
+        {
+            fprintf(file, "unknown");
+            return;
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+        Dl_info info;
+        if (dladdr(callSite, &info) != 0)
+        {
+            if (info.dli_sname != nullptr)
+            {
+                fprintf(file, "%s+0x%zx", info.dli_sname, (size_t)((char *)callSite - (char *)info.dli_saddr));
+                return;
+            }
+
+            if (info.dli_fname != nullptr)
+            {
+                fprintf(file, "%s+0x%zx", info.dli_fname, (size_t)((char *)callSite - (char *)info.dli_fbase));
+                return;
+            }
+        }
+#endif
+        fprintf(file, "%p", callSite);
+    }
+
+    static void PrintHistory(FILE *file, const History *history)
+    {
+        static const char *kindNames[] = { "Retain", "Release", "Destroyed" };
+
+        fprintf(file, "[Instrumentation] History of %p (%s):\n", history->address, history->typeName.empty() ? "unresolved" : history->typeName.c_str());
+        for (const HistoryEvent &event : history->events)
+        {
+            fprintf(file, "[Instrumentation]     %s", kindNames[(int)event.kind]);
+            if (event.kind != HistoryEvent::Kind::Destroyed)
+            {
+                fprintf(file, " -> %u at ", event.count);
+                PrintCallSite(file, event.callSite);
+            }
+
+            fprintf(file, "\n");
+        }
+    }
+#endif
+
+    // Counts
+
+    size_t Instrumentation::LiveCount()
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        return registry.objects.size();
+#else
+        return 0;
+#endif
+    }
+
+    size_t Instrumentation::PeakCount()
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        return registry.peak;
+#else
+        return 0;
+#endif
+    }
+
+    std::vector<Instrumentation::TypeStatistics> Instrumentation::GetTypeStatistics()
+    {
+        std::vector<TypeStatistics> statistics;
+
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        for (auto &[obj, record] : registry.objects)
+            Resolve(registry, obj, record);
+
+        for (const auto &[index, type] : registry.types)
+            statistics.push_back({ type.name.c_str(), type.live, type.peak, type.total });
+#endif
+
+        return statistics;
+    }
+
+    // Retain/release history
+
+    void Instrumentation::TrackHistory(Object *obj, bool track)
+    {
+        if (obj == nullptr)
+            throw Error::NullError("Instrumentation", "TrackHistory", "obj");
+
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        auto iterator = registry.objects.find(obj);
+        if (iterator == registry.objects.end())
+            return;
+
+        ObjectRecord &record = iterator->second;
+        if (track && record.history == nullptr)
+        {
+            record.history = new History { obj, std::string(), { } };
+            registry.histories.push_back(record.history);
+            Resolve(registry, obj, record);
+        }
+        else if (!track)
+            record.history = nullptr;
+#else
+        (void)track;
+#endif
+    }
+
+    void Instrumentation::ClearHistory()
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        for (auto &[obj, record] : registry.objects)
+            record.history = nullptr;
+
+        for (History *history : registry.histories)
+            delete history;
+
+        registry.histories.clear();
+#endif
+    }
+
+    // Reports
+
+    void Instrumentation::Report(FILE *file)
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        for (auto &[obj, record] : registry.objects)
+            Resolve(registry, obj, record);
+
+        fprintf(file, "[Instrumentation] %zu live objects, peak %zu.\n", registry.objects.size(), registry.peak);
+
+        for (const auto &[index, type] : registry.types)
+            fprintf(file, "[Instrumentation] %s: %zu live, peak %zu, %zu total.\n", type.name.c_str(), type.live, type.peak, type.total);
+
+        for (const auto &[obj, record] : registry.objects)
+        {
+            fprintf(file, "[Instrumentation] Live %s at %p, allocated by ", registry.types[std::type_index(*record.type)].name.c_str(), (const void *)obj);
+            PrintCallSite(file, record.callSite);
+            fprintf(file, "\n");
+        }
+
+        for (const History *history : registry.histories)
+            PrintHistory(file, history);
+#else
+        fprintf(file, "[Instrumentation] Instrumentation is disabled; define SCOOP_MEMORY_INSTRUMENTATION to enable it.\n");
+#endif
+    }
+
+    void Instrumentation::ReportAtExit()
+    {
+        static std::once_flag once;
+        std::call_once(once, [] { atexit([] { Report(stderr); }); });
+    }
+
+    // Hooks called by Object
+
+    void Instrumentation::SetAllocationCallSite(void *callSite)
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        allocationCallSite = callSite;
+#else
+        (void)callSite;
+#endif
+    }
+
+    void Instrumentation::ObjectCreated(Object *obj)
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        void *callSite = allocationCallSite;
+        allocationCallSite = nullptr;
+
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        registry.objects[obj] = { callSite, nullptr, nullptr };
+        if (registry.objects.size() > registry.peak)
+            registry.peak = registry.objects.size();
+#else
+        (void)obj;
+#endif
+    }
+
+    void Instrumentation::ObjectDestroying(Object *obj)
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        auto iterator = registry.objects.find(obj);
+        if (iterator != registry.objects.end())
+            Resolve(registry, obj, iterator->second);
+#else
+        (void)obj;
+#endif
+    }
+
+    void Instrumentation::ObjectDestroyed(Object *obj)
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        auto iterator = registry.objects.find(obj);
+        if (iterator == registry.objects.end())
+            return;
+
+        ObjectRecord &record = iterator->second;
+        if (record.type != nullptr)
+            registry.types[std::type_index(*record.type)].live--;
+
+        if (record.history != nullptr)
+            record.history->events.push_back({ HistoryEvent::Kind::Destroyed, 0, nullptr });
+
+        registry.objects.erase(iterator);
+#else
+        (void)obj;
+#endif
+    }
+
+    void Instrumentation::ReferenceChanged(Object *obj, bool retain, unsigned int count, void *callSite)
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        auto iterator = registry.objects.find(obj);
+        if (iterator == registry.objects.end())
+            return;
+
+        ObjectRecord &record = iterator->second;
+        Resolve(registry, obj, record);
+
+        if (record.history != nullptr)
+            record.history->events.push_back({ retain ? HistoryEvent::Kind::Retain : HistoryEvent::Kind::Release, count, callSite });
+#else
+        (void)obj;
+        (void)retain;
+        (void)count;
+        (void)callSite;
+#endif
+    }
+}
\ No newline at end of file
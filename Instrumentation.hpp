@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SCOOP_MEMORY_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define SCOOP_MEMORY_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace Scoop::Memory
+{
+    // Live-object tracking, compiled in when SCOOP_MEMORY_INSTRUMENTATION is defined
+
+    class Instrumentation
+    {
+        public:
+            struct TypeStatistics
+            {
+                const char *name;
+                size_t live;
+                size_t peak;
+                size_t total;
+            };
+
+            // Availability
+
+            static constexpr bool IsEnabled()
+            {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+                return true;
+#else
+                return false;
+#endif
+            }
+
+            // Counts
+
+            static size_t LiveCount();
+            static size_t PeakCount();
+            static std::vector<TypeStatistics> GetTypeStatistics();
+
+            // Retain/release history
+
+            static void TrackHistory(Object *obj, bool track = true);
+            static void ClearHistory();
+
+            // Reports
+
+            static void Report(FILE *file = stderr);
+            static void ReportAtExit();
+
+            // Hooks called by Object
+
+            static void SetAllocationCallSite(void *callSite);
+            static void ObjectCreated(Object *obj);
+            static void ObjectDestroying(Object *obj);
+            static void ObjectDestroyed(Object *obj);
+            static void ReferenceChanged(Object *obj, bool retain, unsigned int count, void *callSite);
+
+            // Prohibit construction
+
+            Instrumentation() = delete;
+    };
+}
\ No newline at end of file
@@ -4,12 +4,25 @@
 
 #include <Memory/Object.hpp>
 #include <Memory/String.hpp>
+#include <Memory/StringBuilder.hpp>
+#include <Memory/FileReader.hpp>
 
 // Memory management classes
 
 #include <Memory/Property.hpp>
+#include <Memory/WeakProperty.hpp>
+#include <Memory/AtomicProperty.hpp>
+#include <Memory/StringView.hpp>
+#include <Memory/AutoreleasePool.hpp>
+#include <Memory/Arena.hpp>
+#include <Memory/StringTable.hpp>
+#include <Memory/CycleCollector.hpp>
+#include <Memory/Instrumentation.hpp>
 #include <Memory/Array.hpp>
 #include <Memory/Dictionary.hpp>
+#include <Memory/PersistentDictionary.hpp>
+#include <Memory/PoolAllocator.hpp>
+#include <Memory/StringKernels.hpp>
 
 // Error
 
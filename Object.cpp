@@ -2,15 +2,182 @@
 
 namespace Scoop::Memory
 {
+#if defined(SCOOP_MEMORY_POOLED_ALLOCATION) || defined(SCOOP_MEMORY_INSTRUMENTATION)
+    // Allocation
+
+    void *Object::operator new(size_t size)
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Instrumentation::SetAllocationCallSite(SCOOP_MEMORY_RETURN_ADDRESS());
+#endif
+
+#ifdef SCOOP_MEMORY_POOLED_ALLOCATION
+        return PoolAllocator::Allocate(size);
+#else
+        return ::operator new(size);
+#endif
+    }
+
+    void Object::operator delete(void *ptr, size_t size)
+    {
+#ifdef SCOOP_MEMORY_POOLED_ALLOCATION
+        PoolAllocator::Deallocate(ptr, size);
+#else
+        ::operator delete(ptr, size);
+#endif
+    }
+#endif
+
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+    // Instrumentation
+
+    void Object::InstrumentCreation()
+    { Instrumentation::ObjectCreated(this); }
+#endif
+
+    // Destructor
+
+    Object::~Object()
+    {
+        // Removed here rather than in Destroy, since arenas destroy their objects without it
+
+        if (this->collectorCandidate.load(std::memory_order_relaxed))
+            CycleCollector::RemoveCandidate(this);
+
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Instrumentation::ObjectDestroyed(this);
+#endif
+
+        if (this->weaklyReferenced.load(std::memory_order_acquire))
+            WeakReference::ObjectDestroyed(this);
+    }
+
+    // Reference counting mode
+
+    void Object::SetReferenceCounting(ReferenceCounting mode)
+    { this->atomicReferenceCount = mode == ReferenceCounting::Atomic; }
+
+    ReferenceCounting Object::GetReferenceCounting() const
+    { return this->atomicReferenceCount ? ReferenceCounting::Atomic : ReferenceCounting::NonAtomic; }
+
+    // Arena allocation
+
+    bool Object::IsArenaAllocated() const
+    { return this->arenaAllocated; }
+
+    // Cycle collection
+
+    bool Object::HasChildren() const
+    { return false; }
+
+    void Object::EnumerateChildren(ChildVisitor, void *) const
+    { }
+
+    void Object::ClearChildren()
+    { }
+
+    // Reference counting
+
     unsigned int Object::GetReferenceCount() const
-    { return this->referenceCount; }
-    
+    { return this->referenceCount.load(std::memory_order_acquire); }
+
     void Object::Retain()
-    { this->referenceCount++; }
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Instrumentation::ReferenceChanged(this, true, this->GetReferenceCount() + 1, SCOOP_MEMORY_RETURN_ADDRESS());
+#endif
+
+        if (this->atomicReferenceCount)
+            this->referenceCount.fetch_add(1, std::memory_order_relaxed);
+        else
+            this->referenceCount.store(this->referenceCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    bool Object::TryRetain()
+    {
+        // Retains only while the object is alive, so that a weak reference cannot resurrect it
+
+        unsigned int count = this->referenceCount.load(std::memory_order_relaxed);
+        if (!this->atomicReferenceCount)
+        {
+            if (count == 0)
+                return false;
+
+            this->referenceCount.store(count + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        do
+        {
+            if (count == 0)
+                return false;
+        }
+        while (!this->referenceCount.compare_exchange_weak(count, count + 1, std::memory_order_relaxed));
+
+        return true;
+    }
 
     void Object::Release()
     {
-        if (--this->referenceCount == 0)
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        Instrumentation::ReferenceChanged(this, false, this->GetReferenceCount() - 1, SCOOP_MEMORY_RETURN_ADDRESS());
+#endif
+
+        if (this->atomicReferenceCount)
+        {
+            // Writes made through this reference must be visible to whichever thread deletes the object
+
+            // Once the count is decremented, another thread may free the object, so it is never buffered as a candidate
+
+            if (this->referenceCount.fetch_sub(1, std::memory_order_release) == 1)
+            {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                this->Destroy();
+            }
+
+            return;
+        }
+
+        // The count reaches zero before the object is destroyed, so a weak reference locked from a destructor fails
+
+        unsigned int count = this->referenceCount.load(std::memory_order_relaxed) - 1;
+        this->referenceCount.store(count, std::memory_order_relaxed);
+
+        if (count == 0)
+        {
+            this->Destroy();
+            return;
+        }
+
+        // A decrement that does not free the object may have left a cycle of garbage behind
+
+        if (CycleCollector::IsEnabled())
+            CycleCollector::AddCandidate(this);
+    }
+
+    void Object::Destroy()
+    {
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        // The dynamic type is only available until the destructor starts
+
+        Instrumentation::ObjectDestroying(this);
+#endif
+
+        // Objects owned by an arena are destroyed along with it
+
+        if (!this->arenaAllocated)
             delete this;
     }
+
+    // Deferred release
+
+    Object *Object::Autorelease()
+    {
+        AutoreleasePool *pool = AutoreleasePool::Current();
+        if (pool == nullptr)
+            throw Error::Create("Object", "Autorelease", "No autorelease pool is in place on this thread.");
+
+        pool->AddObject(this);
+        return this;
+    }
 }
\ No newline at end of file
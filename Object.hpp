@@ -1,23 +1,106 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
 namespace Scoop::Memory
 {
+    // Reference counting mode
+
+    enum class ReferenceCounting
+    {
+        NonAtomic,
+        Atomic
+    };
+
+#ifdef SCOOP_MEMORY_ATOMIC_REFCOUNT
+    constexpr ReferenceCounting DefaultReferenceCounting = ReferenceCounting::Atomic;
+#else
+    constexpr ReferenceCounting DefaultReferenceCounting = ReferenceCounting::NonAtomic;
+#endif
+
+    class Arena;
+    class CycleCollector;
+    class Object;
+    class WeakReference;
+
+    using ChildVisitor = void (*)(Object *child, void *context);
+
     class Object
     {
+        friend class Arena;
+        friend class CycleCollector;
+        friend class StringTable;
+        friend class WeakReference;
+
         private:
-            unsigned int referenceCount;
+            std::atomic<unsigned int> referenceCount;
+            bool atomicReferenceCount;
+            bool arenaAllocated;
+            std::atomic<bool> weaklyReferenced;
+            std::atomic<bool> collectorCandidate;
+
+            // Set by Arena immediately before it constructs an object, and consumed by that object's constructor
+
+            static inline thread_local bool constructingInArena = false;
+
+            void Destroy();
+            bool TryRetain();
+
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+            void InstrumentCreation();
+#endif
+
+        protected:
+            void SetReferenceCounting(ReferenceCounting mode);
 
         public:
-            Object() : referenceCount(1) { }
-            virtual ~Object() = default;
+            Object() : Object(DefaultReferenceCounting) { }
+            explicit Object(ReferenceCounting mode) : referenceCount(1), atomicReferenceCount(mode == ReferenceCounting::Atomic), arenaAllocated(constructingInArena), weaklyReferenced(false), collectorCandidate(false)
+            {
+                constructingInArena = false;
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+                this->InstrumentCreation();
+#endif
+            }
+
+            virtual ~Object();
+
+#if defined(SCOOP_MEMORY_POOLED_ALLOCATION) || defined(SCOOP_MEMORY_INSTRUMENTATION)
+            // Allocation, routed through the pool and recording call sites when enabled
+
+            static void *operator new(size_t size);
+            static void operator delete(void *ptr, size_t size);
+#endif
 
             // Reference counting
 
             unsigned int GetReferenceCount() const;
+            ReferenceCounting GetReferenceCounting() const;
 
             void Retain();
             void Release();
 
+            // Arena allocation
+
+            bool IsArenaAllocated() const;
+
+            // Cycle collection; containers override these so that the collector can traverse and break cycles
+
+            virtual bool HasChildren() const;
+            virtual void EnumerateChildren(ChildVisitor visitor, void *context) const;
+            virtual void ClearChildren();
+
+            // Deferred release
+
+            Object *Autorelease();
+            template <class T> T *Autorelease()
+            {
+                Object *object = this->Autorelease();
+                return static_cast<T *>(object);
+            }
+
             // Prohibit copying
 
             Object(const Object &) = delete;
@@ -28,4 +111,13 @@ namespace Scoop::Memory
             Object(Object &&) = delete;
             void operator=(Object &&) = delete;
     };
+
+    // Thread-safe variant of any Object subclass
+
+    template <class T> class ThreadSafe : public T
+    {
+        public:
+            template <typename ... Args> explicit ThreadSafe(Args && ... args) : T(std::forward<Args>(args) ...)
+            { this->SetReferenceCounting(ReferenceCounting::Atomic); }
+    };
 }
\ No newline at end of file
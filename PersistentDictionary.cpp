@@ -0,0 +1,626 @@
+#include "PersistentDictionary.hpp"
+
+#include <cstring>
+
+static std::string_view KeyView(const char *key, const char *methodName)
+{
+    if (key == nullptr)
+        throw Error::NullError("PersistentDictionary", methodName, "key");
+    return std::string_view(key);
+}
+
+static void AssertValidKey(std::string_view key, const char *methodName)
+{
+    if (key.empty())
+        throw Error::EmptyError("PersistentDictionary", methodName, "key");
+}
+
+static void AssertValidKey(const String *key, const char *methodName)
+{
+    if (key == nullptr)
+        throw Error::NullError("PersistentDictionary", methodName, "key");
+    if (key->Empty())
+        throw Error::EmptyError("PersistentDictionary", methodName, "key");
+}
+
+static void AssertValidValue(const Object *value, const char *methodName)
+{
+    if (value == nullptr)
+        throw Error::NullError("PersistentDictionary", methodName, "value");
+}
+
+namespace Scoop::Memory
+{
+    // Each level consumes 5 bits of the hash; keys whose hashes are fully equal share a collision node
+
+    static constexpr unsigned BitsPerLevel = 5;
+    static constexpr unsigned HashBits = sizeof(size_t) * 8;
+
+    static uint32_t BitFor(size_t hash, unsigned shift)
+    { return (uint32_t)1 << ((hash >> shift) & 31); }
+
+    static size_t PopulationCount(uint32_t bits)
+    {
+#ifdef __GNUC__
+        return (size_t)__builtin_popcount(bits);
+#else
+        bits = bits - ((bits >> 1) & 0x55555555);
+        bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+        return (size_t)((((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+#endif
+    }
+
+    static size_t PositionOf(uint32_t bitmap, uint32_t bit)
+    { return PopulationCount(bitmap & (bit - 1)); }
+
+    // Node
+
+    struct PersistentDictionary::Node
+    {
+        // Slots are ordered by their bit in the bitmap; a slot holds either an entry or a child node
+
+        uint32_t bitmap = 0;
+        bool collision = false;
+        std::vector<Slot> slots;
+
+        Node() = default;
+
+        Node(const Node &other) : bitmap(other.bitmap), collision(other.collision), slots(other.slots)
+        {
+            // Every node holds its own reference to the keys and values of its entries
+
+            for (const Slot &slot : this->slots)
+            {
+                if (slot.key != nullptr)
+                {
+                    slot.key->Retain();
+                    slot.value->Retain();
+                }
+            }
+        }
+
+        ~Node()
+        {
+            for (const Slot &slot : this->slots)
+            {
+                if (slot.key != nullptr)
+                {
+                    slot.key->Release();
+                    slot.value->Release();
+                }
+            }
+        }
+
+        void InsertEntry(size_t position, const Slot &entry)
+        {
+            entry.key->Retain();
+            entry.value->Retain();
+            this->slots.insert(this->slots.begin() + position, Slot { entry.hash, entry.key, entry.value, nullptr });
+        }
+
+        void ReplaceEntry(size_t position, String *key, Object *value)
+        {
+            Slot &slot = this->slots[position];
+            String *oldKey = slot.key;
+            Object *oldValue = slot.value;
+
+            key->Retain();
+            value->Retain();
+            slot.key = key;
+            slot.value = value;
+
+            oldKey->Release();
+            oldValue->Release();
+        }
+
+        void ReleaseEntry(size_t position)
+        {
+            Slot &slot = this->slots[position];
+            String *key = slot.key;
+            Object *value = slot.value;
+
+            slot.key = nullptr;
+            slot.value = nullptr;
+
+            key->Release();
+            value->Release();
+        }
+    };
+
+    static bool KeyEquals(const String *key, size_t keyHash, std::string_view other, size_t hash)
+    { return key != nullptr && keyHash == hash && key->Length() == other.size() && memcmp(key->CString(), other.data(), other.size()) == 0; }
+
+    PersistentDictionary::PersistentDictionary(std::shared_ptr<const Node> root, size_t count) : root(std::move(root)), count(count)
+    { }
+
+    PersistentDictionary::~PersistentDictionary() = default;
+
+    // Trie operations
+
+    std::shared_ptr<const PersistentDictionary::Node> PersistentDictionary::Insert(const std::shared_ptr<const Node> &node, unsigned shift, String *key, Object *value, size_t hash, bool *added)
+    {
+        std::string_view view(key->CString(), key->Length());
+
+        if (node->collision)
+        {
+            size_t size = node->slots.size();
+            for (size_t i = 0; i < size; i++)
+            {
+                const Slot &slot = node->slots[i];
+                if (!KeyEquals(slot.key, slot.hash, view, hash))
+                    continue;
+
+                if (slot.key == key && slot.value == value)
+                    return node;
+
+                std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
+                copy->ReplaceEntry(i, key, value);
+                return copy;
+            }
+
+            std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
+            copy->InsertEntry(size, Slot { hash, key, value, nullptr });
+            *added = true;
+
+            return copy;
+        }
+
+        uint32_t bit = BitFor(hash, shift);
+        size_t position = PositionOf(node->bitmap, bit);
+
+        if ((node->bitmap & bit) == 0)
+        {
+            std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
+            copy->InsertEntry(position, Slot { hash, key, value, nullptr });
+            copy->bitmap |= bit;
+            *added = true;
+
+            return copy;
+        }
+
+        const Slot &slot = node->slots[position];
+        if (slot.child != nullptr)
+        {
+            std::shared_ptr<const Node> child = Insert(slot.child, shift + BitsPerLevel, key, value, hash, added);
+            if (child == slot.child)
+                return node;
+
+            std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
+            copy->slots[position].child = std::move(child);
+            return copy;
+        }
+
+        if (KeyEquals(slot.key, slot.hash, view, hash))
+        {
+            if (slot.key == key && slot.value == value)
+                return node;
+
+            std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
+            copy->ReplaceEntry(position, key, value);
+            return copy;
+        }
+
+        // A different key occupies the slot, so both entries move one level down
+
+        std::shared_ptr<const Node> child = Merge(shift + BitsPerLevel, slot, Slot { hash, key, value, nullptr });
+
+        std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
+        copy->ReleaseEntry(position);
+        copy->slots[position] = Slot { 0, nullptr, nullptr, std::move(child) };
+        *added = true;
+
+        return copy;
+    }
+
+    std::shared_ptr<const PersistentDictionary::Node> PersistentDictionary::Merge(unsigned shift, const Slot &first, const Slot &second)
+    {
+        std::shared_ptr<Node> node = std::make_shared<Node>();
+
+        if (shift >= HashBits)
+        {
+            node->collision = true;
+            node->InsertEntry(0, first);
+            node->InsertEntry(1, second);
+
+            return node;
+        }
+
+        uint32_t firstBit = BitFor(first.hash, shift);
+        uint32_t secondBit = BitFor(second.hash, shift);
+
+        if (firstBit == secondBit)
+        {
+            node->bitmap = firstBit;
+            node->slots.push_back(Slot { 0, nullptr, nullptr, Merge(shift + BitsPerLevel, first, second) });
+        }
+        else
+        {
+            node->bitmap = firstBit | secondBit;
+            node->InsertEntry(0, first);
+            node->InsertEntry(firstBit < secondBit ? 1 : 0, second);
+        }
+
+        return node;
+    }
+
+    std::shared_ptr<const PersistentDictionary::Node> PersistentDictionary::Remove(const std::shared_ptr<const Node> &node, unsigned shift, std::string_view key, size_t hash)
+    {
+        if (node->collision)
+        {
+            size_t size = node->slots.size();
+            for (size_t i = 0; i < size; i++)
+            {
+                const Slot &slot = node->slots[i];
+                if (!KeyEquals(slot.key, slot.hash, key, hash))
+                    continue;
+
+                std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
+                copy->ReleaseEntry(i);
+                copy->slots.erase(copy->slots.begin() + i);
+
+                return copy;
+            }
+
+            return node;
+        }
+
+        uint32_t bit = BitFor(hash, shift);
+        if ((node->bitmap & bit) == 0)
+            return node;
+
+        size_t position = PositionOf(node->bitmap, bit);
+        const Slot &slot = node->slots[position];
+
+        if (slot.child != nullptr)
+        {
+            std::shared_ptr<const Node> child = Remove(slot.child, shift + BitsPerLevel, key, hash);
+            if (child == slot.child)
+                return node;
+
+            std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
+
+            // A child left with a single entry is folded back into this node, keeping the trie as shallow as possible
+
+            if (child == nullptr)
+            {
+                copy->slots.erase(copy->slots.begin() + position);
+                copy->bitmap &= ~bit;
+
+                if (copy->slots.empty())
+                    return nullptr;
+            }
+            else if (child->slots.size() == 1 && child->slots[0].key != nullptr)
+            {
+                const Slot &remaining = child->slots[0];
+                remaining.key->Retain();
+                remaining.value->Retain();
+                copy->slots[position] = Slot { remaining.hash, remaining.key, remaining.value, nullptr };
+            }
+            else
+                copy->slots[position].child = std::move(child);
+
+            return copy;
+        }
+
+        if (!KeyEquals(slot.key, slot.hash, key, hash))
+            return node;
+
+        if (node->slots.size() == 1)
+            return nullptr;
+
+        std::shared_ptr<Node> copy = std::make_shared<Node>(*node);
+        copy->ReleaseEntry(position);
+        copy->slots.erase(copy->slots.begin() + position);
+        copy->bitmap &= ~bit;
+
+        return copy;
+    }
+
+    template <class Function> void PersistentDictionary::Enumerate(const Node *node, Function function)
+    {
+        for (const Slot &slot : node->slots)
+        {
+            if (slot.child != nullptr)
+                Enumerate(slot.child.get(), function);
+            else
+                function(slot);
+        }
+    }
+
+    const PersistentDictionary::Slot *PersistentDictionary::FindEntry(std::string_view key, size_t hash) const
+    {
+        if (this->root == nullptr)
+            return nullptr;
+
+        const Node *node = this->root.get();
+
+        for (unsigned shift = 0; ; shift += BitsPerLevel)
+        {
+            if (node->collision)
+            {
+                for (const Slot &slot : node->slots)
+                {
+                    if (KeyEquals(slot.key, slot.hash, key, hash))
+                        return &slot;
+                }
+
+                return nullptr;
+            }
+
+            uint32_t bit = BitFor(hash, shift);
+            if ((node->bitmap & bit) == 0)
+                return nullptr;
+
+            const Slot &slot = node->slots[PositionOf(node->bitmap, bit)];
+            if (slot.child == nullptr)
+                return KeyEquals(slot.key, slot.hash, key, hash) ? &slot : nullptr;
+
+            node = slot.child.get();
+        }
+    }
+
+    PersistentDictionary *PersistentDictionary::WithEntry(String *key, Object *value, size_t hash) const
+    {
+        bool added = false;
+
+        if (this->root == nullptr)
+        {
+            std::shared_ptr<Node> root = std::make_shared<Node>();
+            root->bitmap = BitFor(hash, 0);
+            root->InsertEntry(0, Slot { hash, key, value, nullptr });
+
+            return new PersistentDictionary(std::move(root), 1);
+        }
+
+        std::shared_ptr<const Node> root = Insert(this->root, 0, key, value, hash, &added);
+        return new PersistentDictionary(std::move(root), this->count + (added ? 1 : 0));
+    }
+
+    // Cycle collection
+
+    bool PersistentDictionary::HasChildren() const
+    { return true; }
+
+    void PersistentDictionary::VisitUnsharedValues(const std::shared_ptr<const Node> &node, ChildVisitor visitor, void *context)
+    {
+        // Nodes shared with other versions hold one reference per value for all of them, so only unshared nodes are traversed
+
+        if (node == nullptr || node.use_count() > 1)
+            return;
+
+        for (const Slot &slot : node->slots)
+        {
+            if (slot.child != nullptr)
+                VisitUnsharedValues(slot.child, visitor, context);
+            else
+                visitor(slot.value, context);
+        }
+    }
+
+    void PersistentDictionary::EnumerateChildren(ChildVisitor visitor, void *context) const
+    { VisitUnsharedValues(this->root, visitor, context); }
+
+    void PersistentDictionary::ClearChildren()
+    {
+        std::shared_ptr<const Node> old = std::move(this->root);
+        this->count = 0;
+    }
+
+    // Entry count
+
+    size_t PersistentDictionary::Count() const
+    { return this->count; }
+
+    // Get all keys
+
+    void PersistentDictionary::GetAllKeys(Array *keys) const
+    {
+        if (keys == nullptr)
+            throw Error::NullError("PersistentDictionary", "GetAllKeys", "keys");
+
+        keys->Clear();
+
+        if (this->root == nullptr)
+            return;
+
+        Enumerate(this->root.get(), [keys](const Slot &slot)
+        {
+            // Interned keys cannot change, so they are shared rather than copied
+
+            if (slot.key->IsInterned())
+            {
+                keys->AddObject(slot.key);
+                return;
+            }
+
+            String *key = new String();
+            key->Assign(slot.key);
+            keys->AddObject(key);
+            key->Release();
+        });
+    }
+
+    // Check if dictionary contains key
+
+    bool PersistentDictionary::Contains(const char *key) const
+    { return this->Contains(KeyView(key, "Contains")); }
+
+    bool PersistentDictionary::Contains(std::string_view key) const
+    {
+        AssertValidKey(key, "Contains");
+        return this->FindEntry(key, String::Hash(key.data(), key.size())) != nullptr;
+    }
+
+    bool PersistentDictionary::Contains(const String *key) const
+    {
+        AssertValidKey(key, "Contains");
+        return this->FindEntry(std::string_view(key->CString(), key->Length()), key->Hash()) != nullptr;
+    }
+
+    // Retrieve entry
+
+    Object *PersistentDictionary::GetObject(const char *key) const
+    { return this->GetObject(KeyView(key, "GetObject")); }
+
+    Object *PersistentDictionary::GetObject(std::string_view key) const
+    {
+        Object *object = this->GetObjectIfPresent(key);
+
+        if (object == nullptr)
+            throw Error::Create("PersistentDictionary", "GetObject", "Dictionary does not contain specified key '%.*s'.", (int)key.size(), key.data());
+
+        return object;
+    }
+
+    Object *PersistentDictionary::GetObject(const String *key) const
+    {
+        AssertValidKey(key, "GetObject");
+
+        Object *object = this->GetObjectIfPresent(key);
+
+        if (object == nullptr)
+            throw Error::Create("PersistentDictionary", "GetObject", "Dictionary does not contain specified key '%.*s'.", (int)key->Length(), key->CString());
+
+        return object;
+    }
+
+    Object *PersistentDictionary::GetObjectIfPresent(const char *key) const
+    { return this->GetObjectIfPresent(KeyView(key, "GetObjectIfPresent")); }
+
+    Object *PersistentDictionary::GetObjectIfPresent(std::string_view key) const
+    {
+        AssertValidKey(key, "GetObjectIfPresent");
+
+        const Slot *slot = this->FindEntry(key, String::Hash(key.data(), key.size()));
+        return slot != nullptr ? slot->value : nullptr;
+    }
+
+    Object *PersistentDictionary::GetObjectIfPresent(const String *key) const
+    {
+        AssertValidKey(key, "GetObjectIfPresent");
+
+        const Slot *slot = this->FindEntry(std::string_view(key->CString(), key->Length()), key->Hash());
+        return slot != nullptr ? slot->value : nullptr;
+    }
+
+    // Derive a new version
+
+    PersistentDictionary *PersistentDictionary::With(const char *key, Object *value) const
+    { return this->With(KeyView(key, "With"), value); }
+
+    PersistentDictionary *PersistentDictionary::With(std::string_view key, Object *value) const
+    {
+        AssertValidKey(key, "With");
+        AssertValidValue(value, "With");
+
+        // Replacing the value of an existing key keeps its key object, so no String is allocated
+
+        size_t hash = String::Hash(key.data(), key.size());
+        const Slot *slot = this->FindEntry(key, hash);
+        if (slot != nullptr)
+            return this->WithEntry(slot->key, value, hash);
+
+        String *str = new String();
+        str->AssignData(key.data(), key.size());
+
+        PersistentDictionary *result;
+        try
+        {
+            result = this->WithEntry(str, value, hash);
+        }
+        catch (...)
+        {
+            str->Release();
+            throw;
+        }
+
+        str->Release();
+        return result;
+    }
+
+    PersistentDictionary *PersistentDictionary::With(String *key, Object *value) const
+    {
+        AssertValidKey(key, "With");
+
+        // Only an interned key is shared, since it cannot change; any other key is copied, as the caller may modify it
+
+        if (!key->IsInterned())
+            return this->With(std::string_view(key->CString(), key->Length()), value);
+
+        AssertValidValue(value, "With");
+        return this->WithEntry(key, value, key->Hash());
+    }
+
+    PersistentDictionary *PersistentDictionary::Without(const char *key) const
+    { return this->Without(KeyView(key, "Without")); }
+
+    PersistentDictionary *PersistentDictionary::Without(std::string_view key) const
+    {
+        AssertValidKey(key, "Without");
+
+        if (this->root == nullptr)
+            return new PersistentDictionary();
+
+        std::shared_ptr<const Node> root = Remove(this->root, 0, key, String::Hash(key.data(), key.size()));
+        size_t count = root == this->root ? this->count : this->count - 1;
+
+        return new PersistentDictionary(std::move(root), count);
+    }
+
+    PersistentDictionary *PersistentDictionary::Without(const String *key) const
+    {
+        AssertValidKey(key, "Without");
+        return this->Without(std::string_view(key->CString(), key->Length()));
+    }
+
+    // Conversion to and from Dictionary
+
+    PersistentDictionary *PersistentDictionary::WithEntries(const Dictionary *dictionary) const
+    {
+        if (dictionary == nullptr)
+            throw Error::NullError("PersistentDictionary", "WithEntries", "dictionary");
+
+        PersistentDictionary *result = new PersistentDictionary(this->root, this->count);
+        if (dictionary->storage == nullptr)
+            return result;
+
+        // Only the new version is modified, and nobody else can reach it yet
+
+        for (const Dictionary::Entry &entry : dictionary->storage->entries)
+        {
+            if (entry.key == nullptr)
+                continue;
+
+            if (result->root == nullptr)
+            {
+                std::shared_ptr<Node> root = std::make_shared<Node>();
+                root->bitmap = BitFor(entry.hash, 0);
+                root->InsertEntry(0, Slot { entry.hash, entry.key, entry.value, nullptr });
+
+                result->root = std::move(root);
+                result->count = 1;
+                continue;
+            }
+
+            bool added = false;
+            result->root = Insert(result->root, 0, entry.key, entry.value, entry.hash, &added);
+            if (added)
+                result->count++;
+        }
+
+        return result;
+    }
+
+    void PersistentDictionary::CopyTo(Dictionary *dictionary) const
+    {
+        if (dictionary == nullptr)
+            throw Error::NullError("PersistentDictionary", "CopyTo", "dictionary");
+
+        dictionary->Clear();
+
+        if (this->root == nullptr)
+            return;
+
+        Enumerate(this->root.get(), [dictionary](const Slot &slot) { dictionary->SetObject(slot.key, slot.value); });
+    }
+}
\ No newline at end of file
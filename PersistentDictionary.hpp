@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace Scoop::Memory
+{
+    class PersistentDictionary : public Object
+    {
+        private:
+            // Hash array mapped trie; every version shares the nodes it did not change with the version it was derived from
+
+            struct Node;
+            struct Slot
+            {
+                size_t hash;
+                String *key;
+                Object *value;
+                std::shared_ptr<const Node> child;
+            };
+
+            std::shared_ptr<const Node> root;
+            size_t count = 0;
+
+            PersistentDictionary(std::shared_ptr<const Node> root, size_t count);
+
+            const Slot *FindEntry(std::string_view key, size_t hash) const;
+            PersistentDictionary *WithEntry(String *key, Object *value, size_t hash) const;
+
+            static std::shared_ptr<const Node> Insert(const std::shared_ptr<const Node> &node, unsigned shift, String *key, Object *value, size_t hash, bool *added);
+            static std::shared_ptr<const Node> Merge(unsigned shift, const Slot &first, const Slot &second);
+            static std::shared_ptr<const Node> Remove(const std::shared_ptr<const Node> &node, unsigned shift, std::string_view key, size_t hash);
+
+            template <class Function> static void Enumerate(const Node *node, Function function);
+            static void VisitUnsharedValues(const std::shared_ptr<const Node> &node, ChildVisitor visitor, void *context);
+
+        public:
+            PersistentDictionary() = default;
+            ~PersistentDictionary();
+
+            // Cycle collection
+
+            bool HasChildren() const override;
+            void EnumerateChildren(ChildVisitor visitor, void *context) const override;
+            void ClearChildren() override;
+
+            // Entry count
+
+            size_t Count() const;
+
+            // Get all keys
+
+            void GetAllKeys(Array *keys) const;
+
+            // Check if dictionary contains a key
+
+            bool Contains(const char *key) const;
+            bool Contains(std::string_view key) const;
+            bool Contains(const String *key) const;
+
+            // Retrieve entry
+
+            Object *GetObject(const char *key) const;
+            Object *GetObject(std::string_view key) const;
+            Object *GetObject(const String *key) const;
+
+            Object *GetObjectIfPresent(const char *key) const;
+            Object *GetObjectIfPresent(std::string_view key) const;
+            Object *GetObjectIfPresent(const String *key) const;
+
+            template <class T> T *GetObject(const char *key) const
+            {
+                Object *object = this->GetObject(key);
+                return static_cast<T *>(object);
+            }
+
+            template <class T> T *GetObject(std::string_view key) const
+            {
+                Object *object = this->GetObject(key);
+                return static_cast<T *>(object);
+            }
+
+            template <class T> T *GetObject(const String *key) const
+            {
+                Object *object = this->GetObject(key);
+                return static_cast<T *>(object);
+            }
+
+            template <class T> T *GetObjectIfPresent(const char *key) const
+            {
+                Object *object = this->GetObjectIfPresent(key);
+                return static_cast<T *>(object);
+            }
+
+            template <class T> T *GetObjectIfPresent(std::string_view key) const
+            {
+                Object *object = this->GetObjectIfPresent(key);
+                return static_cast<T *>(object);
+            }
+
+            template <class T> T *GetObjectIfPresent(const String *key) const
+            {
+                Object *object = this->GetObjectIfPresent(key);
+                return static_cast<T *>(object);
+            }
+
+            // Derive a new version; the caller owns the returned reference
+
+            PersistentDictionary *With(const char *key, Object *value) const;
+            PersistentDictionary *With(std::string_view key, Object *value) const;
+            PersistentDictionary *With(String *key, Object *value) const;
+
+            PersistentDictionary *Without(const char *key) const;
+            PersistentDictionary *Without(std::string_view key) const;
+            PersistentDictionary *Without(const String *key) const;
+
+            // Conversion to and from Dictionary
+
+            PersistentDictionary *WithEntries(const Dictionary *dictionary) const;
+            void CopyTo(Dictionary *dictionary) const;
+    };
+}
\ No newline at end of file
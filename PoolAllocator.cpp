@@ -0,0 +1,316 @@
+#include "PoolAllocator.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace Scoop::Memory
+{
+    constexpr size_t ClassCount = PoolAllocator::MaximumSize / PoolAllocator::Granularity;
+
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    static size_t BlockSize(size_t sizeClass)
+    { return (sizeClass + 1) * PoolAllocator::Granularity; }
+
+    // A thread keeps at most a slab's worth of free blocks of each class; beyond that, half of them move to the depot,
+    // so that blocks freed by one thread reach the threads that allocate instead of piling up
+
+    static size_t CacheLimit(size_t sizeClass)
+    { return PoolAllocator::SlabSize / BlockSize(sizeClass); }
+
+    // Detaches up to count blocks from the front of list, returning the first and storing the last and the number detached
+
+    static FreeBlock *DetachBlocks(FreeBlock *&list, size_t count, FreeBlock **last, size_t *detached)
+    {
+        FreeBlock *first = list, *block = nullptr;
+        size_t n = 0;
+
+        for (FreeBlock *next = list; next != nullptr && n < count; n++)
+        {
+            block = next;
+            next = next->next;
+        }
+
+        if (block != nullptr)
+        {
+            list = block->next;
+            block->next = nullptr;
+        }
+
+        *last = block;
+        *detached = n;
+        return n == 0 ? nullptr : first;
+    }
+
+    // Counters are only written by their owning thread, but may be read by any thread
+
+    struct Counters
+    {
+        std::atomic<uint64_t> allocations { 0 };
+        std::atomic<uint64_t> hits { 0 };
+        std::atomic<uint64_t> misses { 0 };
+        std::atomic<uint64_t> oversized { 0 };
+        std::atomic<uint64_t> slabBytes { 0 };
+        std::atomic<int64_t> liveBytes { 0 };
+
+        void Add(PoolAllocator::Statistics &statistics) const
+        {
+            statistics.allocations += this->allocations.load(std::memory_order_relaxed);
+            statistics.hits += this->hits.load(std::memory_order_relaxed);
+            statistics.misses += this->misses.load(std::memory_order_relaxed);
+            statistics.oversized += this->oversized.load(std::memory_order_relaxed);
+            statistics.slabBytes += this->slabBytes.load(std::memory_order_relaxed);
+            statistics.liveBytes += this->liveBytes.load(std::memory_order_relaxed);
+        }
+    };
+
+    static void Increment(std::atomic<uint64_t> &counter, uint64_t amount = 1)
+    { counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+
+    static void Increment(std::atomic<int64_t> &counter, int64_t amount)
+    { counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+
+    // Shared state: free blocks handed back by exited threads and by threads with too many, and statistics of every thread
+
+    struct Depot
+    {
+        std::mutex mutex;
+        FreeBlock *freeLists[ClassCount] = { };
+        size_t freeCounts[ClassCount] = { };
+        std::vector<const Counters *> threads;
+        PoolAllocator::Statistics exited;
+    };
+
+    static Depot &GetDepot()
+    {
+        // Never destroyed, so that objects released during static destruction can still be freed
+
+        static Depot *depot = new Depot();
+        return *depot;
+    }
+
+    struct ThreadCache
+    {
+        FreeBlock *freeLists[ClassCount] = { };
+        size_t freeCounts[ClassCount] = { };
+        char *slab = nullptr;
+        size_t slabRemaining = 0;
+        Counters counters;
+
+        ThreadCache()
+        {
+            Depot &depot = GetDepot();
+            std::lock_guard<std::mutex> lock(depot.mutex);
+            depot.threads.push_back(&this->counters);
+        }
+
+        ~ThreadCache();
+    };
+
+    static thread_local bool threadCacheDestroyed = false;
+
+    ThreadCache::~ThreadCache()
+    {
+        Depot &depot = GetDepot();
+        std::lock_guard<std::mutex> lock(depot.mutex);
+
+        // Hand free blocks to other threads; slabs themselves are never returned to the system
+
+        for (size_t i = 0; i < ClassCount; i++)
+        {
+            while (FreeBlock *block = this->freeLists[i])
+            {
+                this->freeLists[i] = block->next;
+                block->next = depot.freeLists[i];
+                depot.freeLists[i] = block;
+            }
+
+            depot.freeCounts[i] += this->freeCounts[i];
+            this->freeCounts[i] = 0;
+        }
+
+        for (size_t i = 0; i < depot.threads.size(); i++)
+        {
+            if (depot.threads[i] == &this->counters)
+            {
+                depot.threads.erase(depot.threads.begin() + i);
+                break;
+            }
+        }
+
+        this->counters.Add(depot.exited);
+        threadCacheDestroyed = true;
+    }
+
+    static ThreadCache &GetThreadCache()
+    {
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // Allocation
+
+    void *PoolAllocator::Allocate(size_t size)
+    {
+        if (size == 0)
+            size = 1;
+
+        if (size > MaximumSize)
+        {
+            if (!threadCacheDestroyed)
+                Increment(GetThreadCache().counters.oversized);
+
+            return ::operator new(size);
+        }
+
+        size_t sizeClass = (size - 1) / Granularity;
+
+        if (threadCacheDestroyed)
+        {
+            // Without a thread cache, blocks come from the depot, or else from the system allocator at the full size of
+            // their class, since Deallocate pools every block of this size and may hand it out for any size in the class
+
+            Depot &depot = GetDepot();
+            std::lock_guard<std::mutex> lock(depot.mutex);
+            depot.exited.allocations++;
+            depot.exited.liveBytes += (int64_t)size;
+
+            FreeBlock *block = depot.freeLists[sizeClass];
+            if (block != nullptr)
+            {
+                depot.freeLists[sizeClass] = block->next;
+                depot.freeCounts[sizeClass]--;
+                depot.exited.hits++;
+                return block;
+            }
+
+            depot.exited.oversized++;
+            return ::operator new(BlockSize(sizeClass));
+        }
+
+        ThreadCache &cache = GetThreadCache();
+
+        Increment(cache.counters.allocations);
+        Increment(cache.counters.liveBytes, (int64_t)size);
+
+        if (cache.freeLists[sizeClass] == nullptr)
+        {
+            // Adopt a batch of the blocks left in the depot by other threads
+
+            Depot &depot = GetDepot();
+            std::lock_guard<std::mutex> lock(depot.mutex);
+
+            FreeBlock *last;
+            size_t adopted;
+            cache.freeLists[sizeClass] = DetachBlocks(depot.freeLists[sizeClass], CacheLimit(sizeClass) / 2, &last, &adopted);
+            cache.freeCounts[sizeClass] = adopted;
+            depot.freeCounts[sizeClass] -= adopted;
+        }
+
+        FreeBlock *block = cache.freeLists[sizeClass];
+        if (block != nullptr)
+        {
+            cache.freeLists[sizeClass] = block->next;
+            cache.freeCounts[sizeClass]--;
+            Increment(cache.counters.hits);
+            return block;
+        }
+
+        // Carve a new block from the current slab
+
+        size_t blockSize = BlockSize(sizeClass);
+        if (cache.slabRemaining < blockSize)
+        {
+            cache.slab = (char *)malloc(SlabSize);
+            if (cache.slab == nullptr)
+                throw std::bad_alloc();
+
+            cache.slabRemaining = SlabSize;
+            Increment(cache.counters.slabBytes, SlabSize);
+        }
+
+        void *ptr = cache.slab;
+        cache.slab += blockSize;
+        cache.slabRemaining -= blockSize;
+
+        Increment(cache.counters.misses);
+        return ptr;
+    }
+
+    void PoolAllocator::Deallocate(void *ptr, size_t size)
+    {
+        if (ptr == nullptr)
+            return;
+
+        if (size == 0)
+            size = 1;
+
+        if (size > MaximumSize)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        size_t sizeClass = (size - 1) / Granularity;
+        FreeBlock *block = (FreeBlock *)ptr;
+
+        if (threadCacheDestroyed)
+        {
+            Depot &depot = GetDepot();
+            std::lock_guard<std::mutex> lock(depot.mutex);
+            block->next = depot.freeLists[sizeClass];
+            depot.freeLists[sizeClass] = block;
+            depot.freeCounts[sizeClass]++;
+            depot.exited.liveBytes -= (int64_t)size;
+            return;
+        }
+
+        // Blocks freed on another thread join this thread's free list, until it holds more than its limit
+
+        ThreadCache &cache = GetThreadCache();
+        block->next = cache.freeLists[sizeClass];
+        cache.freeLists[sizeClass] = block;
+        Increment(cache.counters.liveBytes, -(int64_t)size);
+
+        size_t limit = CacheLimit(sizeClass);
+        if (++cache.freeCounts[sizeClass] <= limit)
+            return;
+
+        FreeBlock *last;
+        size_t released;
+        FreeBlock *first = DetachBlocks(cache.freeLists[sizeClass], limit / 2, &last, &released);
+        cache.freeCounts[sizeClass] -= released;
+
+        Depot &depot = GetDepot();
+        std::lock_guard<std::mutex> lock(depot.mutex);
+        last->next = depot.freeLists[sizeClass];
+        depot.freeLists[sizeClass] = first;
+        depot.freeCounts[sizeClass] += released;
+    }
+
+    // Statistics
+
+    PoolAllocator::Statistics PoolAllocator::GetStatistics()
+    {
+        Depot &depot = GetDepot();
+        std::lock_guard<std::mutex> lock(depot.mutex);
+
+        Statistics statistics = depot.exited;
+        for (const Counters *counters : depot.threads)
+            counters->Add(statistics);
+
+        return statistics;
+    }
+
+    double PoolAllocator::Statistics::HitRate() const
+    { return this->allocations == 0 ? 0.0 : (double)this->hits / (double)this->allocations; }
+
+    double PoolAllocator::Statistics::Fragmentation() const
+    { return this->slabBytes == 0 ? 0.0 : 1.0 - (double)this->liveBytes / (double)this->slabBytes; }
+}
\ No newline at end of file
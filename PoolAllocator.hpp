@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Scoop::Memory::PoolAllocator
+{
+    // Blocks of up to MaximumSize bytes are pooled in size classes of Granularity bytes
+
+    constexpr size_t Granularity = 16;
+    constexpr size_t MaximumSize = 512;
+    constexpr size_t SlabSize = 64 * 1024;
+
+    struct Statistics
+    {
+        uint64_t allocations = 0; // pooled allocations
+        uint64_t hits = 0; // pooled allocations served from a free list
+        uint64_t misses = 0; // pooled allocations carved from a slab
+        uint64_t oversized = 0; // allocations forwarded to the system allocator
+        uint64_t slabBytes = 0; // bytes reserved for slabs
+        int64_t liveBytes = 0; // requested bytes of live pooled allocations
+
+        double HitRate() const; // hits / allocations
+        double Fragmentation() const; // fraction of slab bytes not holding live data
+    };
+
+    void *Allocate(size_t size);
+    void Deallocate(void *ptr, size_t size);
+
+    Statistics GetStatistics();
+}
\ No newline at end of file
@@ -15,6 +15,40 @@ namespace Scoop::Memory
                     obj->Release();
             }
 
+            // Copying retains the held object
+
+            Property(const Property &other) : obj(other.obj)
+            {
+                if (this->obj != nullptr)
+                    this->obj->Retain();
+            }
+
+            Property &operator=(const Property &other)
+            {
+                this->Assign(other.obj);
+                return *this;
+            }
+
+            // Moving transfers the reference without retaining or releasing
+
+            Property(Property &&other) noexcept : obj(other.obj)
+            { other.obj = nullptr; }
+
+            Property &operator=(Property &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    T *oldObj = this->obj;
+                    this->obj = other.obj;
+                    other.obj = nullptr;
+
+                    if (oldObj != nullptr)
+                        oldObj->Release();
+                }
+
+                return *this;
+            }
+
             // Access
 
             T *Get() const { return this->obj; }
@@ -25,13 +59,26 @@ namespace Scoop::Memory
 
             void Assign(T *newObj)
             {
-                if (this->obj != nullptr)
-                    this->obj->Release();
+                if (newObj == this->obj)
+                    return;
+
+                // Retain first, in case the new object is only kept alive by the old one
 
                 if (newObj != nullptr)
                     newObj->Retain();
 
+                this->Adopt(newObj);
+            }
+
+            void Adopt(T *newObj)
+            {
+                // Takes over a reference the caller already owns, such as one returned by new
+
+                T *oldObj = this->obj;
                 this->obj = newObj;
+
+                if (oldObj != nullptr)
+                    oldObj->Release();
             }
 
             T *operator=(T *newObj)
@@ -43,10 +90,6 @@ namespace Scoop::Memory
             // Allocate new object
 
             void AllocateNew()
-            {
-                T *newObj = new T();
-                this->Assign(newObj);
-                newObj->Release();
-            }
+            { this->Adopt(new T()); }
     };
 }
\ No newline at end of file
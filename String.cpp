@@ -1,31 +1,164 @@
 #include "String.hpp"
 
+#include <cerrno>
 #include <cstdlib>
 #include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace Scoop::Memory
 {
     // Constructor
 
-    String::String()
-    { this->Assign(""); }
+    String::String() = default;
 
     // Destructor
 
     String::~String()
     {
-        if (this->data != nullptr)
-            free(this->data);
+        if (this->table != nullptr)
+            this->table->Remove(this);
+
+        this->Deallocate();
     };
 
+    // Storage
+
+#ifndef _WIN32
+    static size_t MappingLength(size_t capacity)
+    {
+        // Mappings always extend at least one byte past the file, which holds the null-terminator
+
+        size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+        return (capacity + pageSize) / pageSize * pageSize;
+    }
+#endif
+
+    // Heap buffers of an arena-allocated string come from its arena, and are freed along with it
+
+    static char *AllocateBuffer(const Object *owner, size_t size)
+    {
+        Arena *arena = Arena::Of(owner);
+        return arena != nullptr ? (char *)arena->Allocate(size, 1) : (char *)malloc(size);
+    }
+
+    void String::Deallocate()
+    {
+#ifndef _WIN32
+        if (this->mapped)
+        {
+            munmap(this->data, MappingLength(this->capacity));
+            this->mapped = false;
+        }
+        else
+#endif
+        if (this->data != this->inlineData && !this->IsArenaAllocated())
+            free(this->data);
+
+        this->data = this->inlineData;
+        this->capacity = InlineCapacity;
+    }
+
+    // Interning
+
+    bool String::IsInterned() const
+    { return this->interned; }
+
+    void String::BeginModification(const char *methodName)
+    {
+        if (this->interned)
+            throw Error::Create("String", methodName, "String is interned and cannot be modified.");
+
+        this->hash.store(0, std::memory_order_relaxed);
+    }
+
+    // Capacity
+
+    size_t String::Capacity() const
+    { return this->capacity; }
+
+    void String::Reallocate(size_t capacity)
+    {
+        if (this->mapped)
+        {
+            // Copy out of the file mapping into storage owned by this string
+
+            char *data = capacity <= InlineCapacity ? this->inlineData : AllocateBuffer(this, capacity + 1);
+            memcpy(data, this->data, this->length + 1);
+            this->Deallocate();
+
+            if (data != this->inlineData)
+            {
+                this->data = data;
+                this->capacity = capacity;
+            }
+
+            return;
+        }
+
+        if (capacity <= InlineCapacity)
+        {
+            // Move back into the inline buffer
+
+            if (this->data != this->inlineData)
+            {
+                memcpy(this->inlineData, this->data, this->length + 1);
+                if (!this->IsArenaAllocated())
+                    free(this->data);
+
+                this->data = this->inlineData;
+            }
+
+            this->capacity = InlineCapacity;
+            return;
+        }
+
+        if (this->data == this->inlineData || this->IsArenaAllocated())
+        {
+            char *data = AllocateBuffer(this, capacity + 1);
+            memcpy(data, this->data, this->length + 1);
+            this->data = data;
+        }
+        else
+            this->data = (char *)realloc(this->data, capacity + 1);
+
+        this->capacity = capacity;
+    }
+
+    void String::Reserve(size_t capacity)
+    {
+        this->BeginModification("Reserve");
+
+        if (capacity > this->capacity)
+            this->Reallocate(capacity);
+    }
+
+    void String::ShrinkToFit()
+    {
+        this->BeginModification("ShrinkToFit");
+
+        if (this->capacity > this->length && this->data != this->inlineData)
+            this->Reallocate(this->length);
+    }
+
     // Resize
 
     void String::Resize(size_t length)
     {
-        if (this->data == nullptr)
-            this->data = (char *)malloc(length + 1);
-        else
-            this->data = (char *)realloc(this->data, length + 1);
+        // Grow geometrically so that repeated appends and inserts take amortized constant time
+
+        if (length > this->capacity)
+            this->Reallocate(length > this->capacity * 2 ? length : this->capacity * 2);
+
+        this->length = length;
+        this->data[length] = '\0';
     }
 
     // Copy
@@ -36,7 +169,7 @@ namespace Scoop::Memory
     // Length
 
     size_t String::Length() const
-    { return strlen(this->data); }
+    { return this->length; }
 
     // Data access
 
@@ -45,9 +178,10 @@ namespace Scoop::Memory
 
     char &String::GetCharacter(size_t index)
     {
-        size_t length = strlen(this->data);
-        if (index >= length)
-            throw Error::IndexError("String", "GetCharacter", index, length);
+        this->BeginModification("GetCharacter");
+
+        if (index >= this->length)
+            throw Error::IndexError("String", "GetCharacter", index, this->length);
 
         return this->data[index];
     }
@@ -55,7 +189,7 @@ namespace Scoop::Memory
     // Value validation
 
     bool String::Empty() const
-    { return strlen(this->data) == 0; }
+    { return this->length == 0; }
 
     bool String::IsNullOrEmpty(const String *string)
     { return string == nullptr || string->Empty(); }
@@ -63,54 +197,73 @@ namespace Scoop::Memory
     // Substring
 
     String::String(const String *str, size_t startIndex, size_t length)
-    { this->Assign(str->data, startIndex, length); }
+    { this->Assign(str, startIndex, length); }
     String::String(const char *str, size_t startIndex, size_t length)
     { this->Assign(str, startIndex, length); }
 
     // Assignment
 
     void String::Assign(const String *source, size_t startIndex, size_t length)
-    { this->Assign(source->data, startIndex, length); }
+    {
+        if (source == nullptr)
+            throw Error::NullError("String", "Assign", "source");
+        if (startIndex > source->length)
+            throw Error::IndexError("String", "Assign", startIndex, source->length);
+
+        size_t sourceLength = source->length - startIndex;
+        if (length != 0 && length < sourceLength)
+            sourceLength = length;
+
+        this->AssignData(source->data + startIndex, sourceLength);
+    }
     
     void String::Assign(const char *source, size_t startIndex, size_t length)
     {
-        if (length == 0)
-            length = strlen(source);
+        // Never read past the requested range, so that source need not be null-terminated
 
-        size_t sourceLength = strlen(source + startIndex);
-        if (sourceLength > length)
-            sourceLength = length;
+        size_t sourceLength = length == 0 ? strlen(source + startIndex) : strnlen(source + startIndex, length);
+        this->AssignData(source + startIndex, sourceLength);
+    }
 
-        this->Resize(sourceLength);
+    void String::AssignData(const char *data, size_t length)
+    {
+        // Assigning from within this string never needs to grow it, so data stays valid
 
-        memcpy(this->data, source + startIndex, sourceLength + 1);
-        this->data[sourceLength] = '\0';
+        this->BeginModification("AssignData");
+        this->Reserve(length);
+        memmove(this->data, data, length);
+        this->Resize(length);
     }
 
     // Format assigment
 
     void String::AssignFormat(const char *format, ...)
     {
-        int final_n, n = ((int)strlen(format)) * 2;
-        std::unique_ptr<char[]> formatted;
-        va_list ap;
+        va_list arguments;
+        va_start(arguments, format);
+        this->AssignFormatV(format, arguments);
+        va_end(arguments);
+    }
+
+    void String::AssignFormatV(const char *format, va_list arguments)
+    {
+        if (format == nullptr)
+            throw Error::NullError("String", "AssignFormat", "format");
 
-        while (true)
-        {
-            formatted.reset(new char[n]);
-            strcpy(&formatted[0], format);
+        this->BeginModification("AssignFormat");
 
-            va_start(ap, format);
-            final_n = vsnprintf(&formatted[0], n, format, ap);
-            va_end(ap);
+        // Arguments may point into this string, so its contents are only replaced once formatting is complete
 
-            if (final_n < 0 || final_n >= n)
-                n += abs(final_n - n + 1);
-            else
-                break;
-        }
+        char buffer[FormatBufferSize];
+        size_t count = FormatInto(buffer, sizeof(buffer), format, arguments, "AssignFormat");
 
-        this->Assign(formatted.get());
+        if (count < sizeof(buffer))
+        {
+            this->Resize(count);
+            memcpy(this->data, buffer, count);
+        }
+        else
+            this->FormatIntoNewBuffer(0, count, count, format, arguments);
     }
 
     // Assign from file
@@ -120,17 +273,106 @@ namespace Scoop::Memory
 
     void String::AssignFromFile(const char *path)
     {
-        FILE *file = fopen(path, "r");
+        if (path == nullptr)
+            throw Error::NullError("String", "AssignFromFile", "path");
+
+        this->BeginModification("AssignFromFile");
+
+        FILE *file = fopen(path, "rb");
+        if (file == nullptr)
+            throw Error::Create("String", "AssignFromFile", "Failed to open file '%s': %s.", path, strerror(errno));
 
-        fseek(file, 0, SEEK_END);
-        size_t size = ftell(file);
-        this->Resize(size);
+        long size = -1;
+        if (fseek(file, 0, SEEK_END) == 0)
+            size = ftell(file);
 
-        fseek(file, 0, SEEK_SET);
-        fread(this->data, 1, size, file);
+        if (size < 0 || fseek(file, 0, SEEK_SET) != 0)
+        {
+            int error = errno;
+            fclose(file);
+            throw Error::Create("String", "AssignFromFile", "Failed to determine the size of file '%s': %s.", path, strerror(error));
+        }
+
+        this->Resize(0);
+        this->Reserve((size_t)size);
+
+        size_t count = fread(this->data, 1, (size_t)size, file);
+        bool failed = ferror(file) != 0;
         fclose(file);
 
-        this->data[size] = '\0';
+        this->Resize(count);
+
+        if (failed)
+            throw Error::Create("String", "AssignFromFile", "Failed to read file '%s'.", path);
+    }
+
+    // Map file
+
+    void String::MapFromFile(const String *path)
+    { this->MapFromFile(path->data); }
+
+    void String::MapFromFile(const char *path)
+    {
+        if (path == nullptr)
+            throw Error::NullError("String", "MapFromFile", "path");
+
+        this->BeginModification("MapFromFile");
+
+#ifndef _WIN32
+        // A mapping must be unmapped by the destructor, which an arena skips for strings
+
+        if (this->IsArenaAllocated())
+        {
+            this->AssignFromFile(path);
+            return;
+        }
+
+        int file = open(path, O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+            throw Error::Create("String", "MapFromFile", "Failed to open file '%s': %s.", path, strerror(errno));
+
+        struct stat info;
+        if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode))
+        {
+            int error = errno;
+            close(file);
+            throw Error::Create("String", "MapFromFile", "File '%s' is not a mappable regular file: %s.", path, strerror(error));
+        }
+
+        size_t size = (size_t)info.st_size;
+        if (size == 0)
+        {
+            close(file);
+            this->Resize(0);
+            return;
+        }
+
+        // Reserve zeroed memory one byte longer than the file, then map the file over its start
+
+        size_t mappingLength = MappingLength(size);
+        void *mapping = mmap(nullptr, mappingLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        bool success = mapping != MAP_FAILED && mmap(mapping, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, file, 0) != MAP_FAILED;
+
+        int error = errno;
+        close(file);
+
+        if (!success)
+        {
+            if (mapping != MAP_FAILED)
+                munmap(mapping, mappingLength);
+
+            throw Error::Create("String", "MapFromFile", "Failed to map file '%s': %s.", path, strerror(error));
+        }
+
+        this->Deallocate();
+
+        this->data = (char *)mapping;
+        this->length = size;
+        this->capacity = size;
+        this->mapped = true;
+#else
+        this->AssignFromFile(path);
+#endif
     }
 
     // String comparison
@@ -139,34 +381,231 @@ namespace Scoop::Memory
     {
         if (this == string)
             return true;
-        return this->IsEqual(string->data);
+        if (this->length != string->length)
+            return false;
+
+        // Hashes that are already cached reject most unequal strings without comparing their contents
+
+        size_t hash = this->hash.load(std::memory_order_relaxed);
+        size_t otherHash = string->hash.load(std::memory_order_relaxed);
+        if (hash != 0 && otherHash != 0 && hash != otherHash)
+            return false;
+
+        return memcmp(this->data, string->data, this->length) == 0;
     }
 
     bool String::IsEqual(const char *string) const
     {
-        size_t length = strlen(this->data);
-        if (length != strlen(string))
+        if (this->length != strlen(string))
             return false;
 
-        return memcmp(this->data, string, length) == 0;
+        return memcmp(this->data, string, this->length) == 0;
     }
 
     int String::Compare(const String *string, size_t maxLength) const
-    { return this->Compare(string->data, maxLength); }
+    {
+        if (string == nullptr)
+            throw Error::NullError("String", "Compare", "string");
+
+        size_t common = this->length < string->length ? this->length : string->length;
+        if (maxLength != 0 && maxLength < common)
+            common = maxLength;
+
+        // Find the first mismatch, which may be the terminator of the shorter string, and let strcmp rank it
+
+        size_t i = 0;
+        if (memcmp(this->data, string->data, common) != 0)
+        {
+            while (this->data[i] == string->data[i])
+                i++;
+        }
+        else if (maxLength != 0 && common == maxLength)
+            return 0;
+        else
+            i = common;
+
+        // Both strings hold a null byte here, so only their lengths differ
+
+        if (this->data[i] == string->data[i])
+            return this->length < string->length ? -1 : this->length > string->length;
+
+        return strcmp(this->data + i, string->data + i);
+    }
 
     int String::Compare(const char *string, size_t maxLength) const
     {
         if (string == nullptr)
             throw Error::NullError("String", "Compare", "string");
         if (maxLength == 0)
-            maxLength = strlen(this->data) + 1;
+            maxLength = this->length + 1;
         return strncmp(this->data, string, maxLength);
     }
 
+    // Case-insensitive comparison
+
+    int String::CompareIgnoringCaseData(const char *data, size_t length) const
+    {
+        size_t common = this->length < length ? this->length : length;
+
+        int result = StringKernels::CompareIgnoringCase(this->data, data, common);
+        if (result != 0)
+            return result;
+
+        return this->length < length ? -1 : this->length > length ? 1 : 0;
+    }
+
+    bool String::IsEqualIgnoringCase(const String *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("String", "IsEqualIgnoringCase", "string");
+        return this->length == string->length && this->CompareIgnoringCaseData(string->data, string->length) == 0;
+    }
+
+    bool String::IsEqualIgnoringCase(const char *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("String", "IsEqualIgnoringCase", "string");
+
+        size_t length = strlen(string);
+        return this->length == length && this->CompareIgnoringCaseData(string, length) == 0;
+    }
+
+    int String::CompareIgnoringCase(const String *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("String", "CompareIgnoringCase", "string");
+        return this->CompareIgnoringCaseData(string->data, string->length);
+    }
+
+    int String::CompareIgnoringCase(const char *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("String", "CompareIgnoringCase", "string");
+        return this->CompareIgnoringCaseData(string, strlen(string));
+    }
+
+    // Hashing
+
+    static uint64_t Read64(const unsigned char *data)
+    {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    static uint64_t Read32(const unsigned char *data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    static void Multiply(uint64_t *low, uint64_t *high)
+    {
+        // Full 64 x 64 -> 128-bit product
+
+#ifdef __SIZEOF_INT128__
+        __uint128_t product = (__uint128_t)*low * *high;
+        *low = (uint64_t)product;
+        *high = (uint64_t)(product >> 64);
+#else
+        uint64_t a = *low, b = *high;
+        uint64_t aHigh = a >> 32, aLow = (uint32_t)a, bHigh = b >> 32, bLow = (uint32_t)b;
+        uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh, highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+        uint64_t middle = (lowLow >> 32) + (uint32_t)lowHigh + (uint32_t)highLow;
+
+        *low = (middle << 32) | (uint32_t)lowLow;
+        *high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+#endif
+    }
+
+    static uint64_t Mix(uint64_t a, uint64_t b)
+    {
+        Multiply(&a, &b);
+        return a ^ b;
+    }
+
+    size_t String::Hash() const
+    {
+        // Strings shared between threads may be hashed concurrently; every thread computes the same value
+
+        size_t hash = this->hash.load(std::memory_order_relaxed);
+        if (hash == 0)
+        {
+            hash = Hash(this->data, this->length);
+            this->hash.store(hash, std::memory_order_relaxed);
+        }
+
+        return hash;
+    }
+
+    size_t String::Hash(const char *data, size_t length)
+    {
+        // wyhash: reads 16 bytes per step, or 48 bytes across three independent lanes for long inputs
+
+        static constexpr uint64_t Secret[4] = { 0xa0761d6478bd642f, 0xe7037ed1a0b428db, 0x8ebc6af09c88c6e3, 0x589965cc75374cc3 };
+
+        const unsigned char *bytes = (const unsigned char *)data;
+        uint64_t seed = Mix(Secret[0], Secret[1]);
+        uint64_t a, b;
+
+        if (length <= 16)
+        {
+            if (length >= 4)
+            {
+                size_t offset = (length >> 3) << 2;
+                a = (Read32(bytes) << 32) | Read32(bytes + offset);
+                b = (Read32(bytes + length - 4) << 32) | Read32(bytes + length - 4 - offset);
+            }
+            else if (length > 0)
+            {
+                a = ((uint64_t)bytes[0] << 16) | ((uint64_t)bytes[length >> 1] << 8) | bytes[length - 1];
+                b = 0;
+            }
+            else
+                a = b = 0;
+        }
+        else
+        {
+            size_t remaining = length;
+            if (remaining > 48)
+            {
+                uint64_t first = seed, second = seed;
+                do
+                {
+                    seed = Mix(Read64(bytes) ^ Secret[1], Read64(bytes + 8) ^ seed);
+                    first = Mix(Read64(bytes + 16) ^ Secret[2], Read64(bytes + 24) ^ first);
+                    second = Mix(Read64(bytes + 32) ^ Secret[3], Read64(bytes + 40) ^ second);
+                    bytes += 48;
+                    remaining -= 48;
+                }
+                while (remaining > 48);
+
+                seed ^= first ^ second;
+            }
+
+            while (remaining > 16)
+            {
+                seed = Mix(Read64(bytes) ^ Secret[1], Read64(bytes + 8) ^ seed);
+                bytes += 16;
+                remaining -= 16;
+            }
+
+            a = Read64(bytes + remaining - 16);
+            b = Read64(bytes + remaining - 8);
+        }
+
+        a ^= Secret[1];
+        b ^= seed;
+        Multiply(&a, &b);
+
+        return (size_t)Mix(a ^ Secret[0] ^ length, b ^ Secret[1]);
+    }
+
     // Affix testing
 
     bool String::StartsWith(const String *str) const
-    { return this->Compare(str, strlen(str->data)) == 0; }
+    { return this->length >= str->length && memcmp(this->data, str->data, str->length) == 0; }
 
     bool String::StartsWith(const char *str) const
     { return this->Compare(str, strlen(str)) == 0; }
@@ -183,96 +622,366 @@ namespace Scoop::Memory
         if (length == 0)
             throw Error::Create("String", "EndsWith", "Specified string is empty.");
 
-        if (length >= strlen(this->data))
+        if (length >= this->length)
             return false;
             
-        return strncmp(this->data + strlen(this->data) - length, str, length) == 0;
+        return memcmp(this->data + this->length - length, str, length) == 0;
+    }
+
+    // Searching
+
+    size_t String::FindData(const char *data, size_t length, size_t startIndex, const char *methodName) const
+    {
+        if (startIndex > this->length)
+            throw Error::IndexError("String", methodName, startIndex, this->length);
+
+        const char *match = StringKernels::Find(this->data + startIndex, this->length - startIndex, data, length);
+        return match != nullptr ? match - this->data : NotFound;
+    }
+
+    size_t String::Find(const String *str, size_t startIndex) const
+    {
+        if (str == nullptr)
+            throw Error::NullError("String", "Find", "string");
+        return this->FindData(str->data, str->length, startIndex, "Find");
+    }
+
+    size_t String::Find(const char *str, size_t startIndex) const
+    {
+        if (str == nullptr)
+            throw Error::NullError("String", "Find", "string");
+        return this->FindData(str, strlen(str), startIndex, "Find");
+    }
+
+    size_t String::FindLast(const String *str) const
+    {
+        if (str == nullptr)
+            throw Error::NullError("String", "FindLast", "string");
+
+        const char *match = StringKernels::FindLast(this->data, this->length, str->data, str->length);
+        return match != nullptr ? match - this->data : NotFound;
+    }
+
+    size_t String::FindLast(const char *str) const
+    {
+        if (str == nullptr)
+            throw Error::NullError("String", "FindLast", "string");
+
+        const char *match = StringKernels::FindLast(this->data, this->length, str, strlen(str));
+        return match != nullptr ? match - this->data : NotFound;
+    }
+
+    bool String::Contains(const String *str) const
+    {
+        if (str == nullptr)
+            throw Error::NullError("String", "Contains", "string");
+        return this->FindData(str->data, str->length, 0, "Contains") != NotFound;
+    }
+
+    bool String::Contains(const char *str) const
+    {
+        if (str == nullptr)
+            throw Error::NullError("String", "Contains", "string");
+        return this->FindData(str, strlen(str), 0, "Contains") != NotFound;
+    }
+
+    size_t String::CountData(const char *data, size_t length) const
+    {
+        if (length == 0)
+            throw Error::EmptyError("String", "Count", "string");
+
+        // Occurrences are counted without overlapping, as Replace would replace them
+
+        size_t count = 0;
+        const char *end = this->data + this->length;
+        for (const char *match = this->data; (match = StringKernels::Find(match, end - match, data, length)) != nullptr; match += length)
+            count++;
+
+        return count;
+    }
+
+    size_t String::Count(const String *str) const
+    {
+        if (str == nullptr)
+            throw Error::NullError("String", "Count", "string");
+        return this->CountData(str->data, str->length);
+    }
+
+    size_t String::Count(const char *str) const
+    {
+        if (str == nullptr)
+            throw Error::NullError("String", "Count", "string");
+        return this->CountData(str, strlen(str));
+    }
+
+    // Replacement
+
+    size_t String::ReplaceData(const char *target, size_t targetLength, const char *replacement, size_t replacementLength)
+    {
+        if (targetLength == 0)
+            throw Error::EmptyError("String", "Replace", "target");
+
+        this->BeginModification("Replace");
+
+        // Arguments that point into this string are copied first, since the string is rewritten in place
+
+        std::vector<char> targetCopy, replacementCopy;
+        if (target >= this->data && target < this->data + this->capacity)
+        {
+            targetCopy.assign(target, target + targetLength);
+            target = targetCopy.data();
+        }
+        if (replacement >= this->data && replacement < this->data + this->capacity)
+        {
+            replacementCopy.assign(replacement, replacement + replacementLength);
+            replacement = replacementCopy.data();
+        }
+
+        std::vector<size_t> positions;
+        const char *end = this->data + this->length;
+        for (const char *match = this->data; (match = StringKernels::Find(match, end - match, target, targetLength)) != nullptr; match += targetLength)
+            positions.push_back(match - this->data);
+
+        size_t count = positions.size();
+        if (count == 0)
+            return 0;
+
+        size_t length = this->length;
+        size_t newLength = length - count * targetLength + count * replacementLength;
+
+        if (replacementLength <= targetLength)
+        {
+            // Shrinking or equal: compact front to back, since the write position never passes the read position
+
+            size_t write = positions[0];
+            for (size_t i = 0; i < count; i++)
+            {
+                memcpy(this->data + write, replacement, replacementLength);
+                write += replacementLength;
+
+                size_t read = positions[i] + targetLength;
+                size_t next = i + 1 < count ? positions[i + 1] : length;
+                memmove(this->data + write, this->data + read, next - read);
+                write += next - read;
+            }
+        }
+        else
+        {
+            // Growing: reserve once, then fill back to front, since the write position never falls behind the read position
+
+            this->Reserve(newLength);
+
+            size_t sourceEnd = length, write = newLength;
+            for (size_t i = count; i-- > 0; )
+            {
+                size_t tail = positions[i] + targetLength;
+                write -= sourceEnd - tail;
+                memmove(this->data + write, this->data + tail, sourceEnd - tail);
+
+                write -= replacementLength;
+                memcpy(this->data + write, replacement, replacementLength);
+                sourceEnd = positions[i];
+            }
+        }
+
+        this->Resize(newLength);
+        return count;
+    }
+
+    size_t String::Replace(const String *target, const String *replacement)
+    {
+        if (target == nullptr)
+            throw Error::NullError("String", "Replace", "target");
+        if (replacement == nullptr)
+            throw Error::NullError("String", "Replace", "replacement");
+        return this->ReplaceData(target->data, target->length, replacement->data, replacement->length);
+    }
+
+    size_t String::Replace(const char *target, const char *replacement)
+    {
+        if (target == nullptr)
+            throw Error::NullError("String", "Replace", "target");
+        if (replacement == nullptr)
+            throw Error::NullError("String", "Replace", "replacement");
+        return this->ReplaceData(target, strlen(target), replacement, strlen(replacement));
     }
 
     // Clear string
 
     void String::Clear()
-    { this->Assign(""); }
+    {
+        this->BeginModification("Clear");
+        this->Resize(0);
+    }
 
     // Append to string
 
     void String::Append(char c)
-    { this->Insert(&c, strlen(this->data), 1); }
+    {
+        this->BeginModification("Append");
+        this->Resize(this->length + 1);
+        this->data[this->length - 1] = c;
+    }
+
     void String::Append(const String *str, size_t count)
-    { this->Insert(str->data, strlen(this->data), count); }
+    {
+        if (count == 0 || count > str->length)
+            count = str->length;
+        this->AppendData(str->data, count);
+    }
+
     void String::Append(const char *str, size_t count)
-    { this->Insert(str, strlen(this->data), count); }
+    {
+        if (count == 0)
+            count = strlen(str);
+        this->AppendData(str, count);
+    }
+
+    void String::AppendData(const char *data, size_t length)
+    { this->InsertData(data, this->length, length); }
 
     void String::AppendFormat(const char *format, ...)
     {
-        int final_n, n = ((int)strlen(format)) * 2;
-        std::unique_ptr<char[]> formatted;
-        va_list ap;
+        va_list arguments;
+        va_start(arguments, format);
+        this->AppendFormatV(format, arguments);
+        va_end(arguments);
+    }
 
-        while (true)
-        {
-            formatted.reset(new char[n]);
-            strcpy(&formatted[0], format);
+    void String::AppendFormatV(const char *format, va_list arguments)
+    {
+        if (format == nullptr)
+            throw Error::NullError("String", "AppendFormat", "format");
+
+        this->BeginModification("AppendFormat");
+
+        // Arguments may point into this string, up to and including its terminator, so results are formatted after the terminator,
+        // into spare capacity when there is enough of it and on the stack otherwise, and only then moved into place
 
-            va_start(ap, format);
-            final_n = vsnprintf(&formatted[0], n, format, ap);
-            va_end(ap);
+        char buffer[FormatBufferSize];
+        size_t length = this->length, spare = this->capacity - length;
+        bool inPlace = spare > sizeof(buffer);
 
-            if (final_n < 0 || final_n >= n)
-                n += abs(final_n - n + 1);
+        char *target = inPlace ? this->data + length + 1 : buffer;
+        size_t size = inPlace ? spare : sizeof(buffer);
+        size_t count = FormatInto(target, size, format, arguments, "AppendFormat");
+
+        if (count < size)
+        {
+            if (!inPlace)
+                this->InsertData(buffer, length, count);
             else
-                break;
+            {
+                memmove(this->data + length, target, count + 1);
+                this->length = length + count;
+            }
+
+            return;
         }
 
-        this->Append(formatted.get());
+        // Grow geometrically into a new buffer, freeing the old one only after formatting
+
+        size_t capacity = length + count > this->capacity * 2 ? length + count : this->capacity * 2;
+        this->FormatIntoNewBuffer(length, count, capacity, format, arguments);
+    }
+
+    size_t String::FormatInto(char *buffer, size_t size, const char *format, va_list arguments, const char *methodName)
+    {
+        // Returns the length of the whole result, which was only written completely if it is less than size
+
+        va_list copy;
+        va_copy(copy, arguments);
+        int count = vsnprintf(buffer, size, format, copy);
+        va_end(copy);
+
+        if (count < 0)
+            throw Error::Create("String", methodName, "Failed to format string '%s'.", format);
+
+        return (size_t)count;
+    }
+
+    void String::FormatIntoNewBuffer(size_t offset, size_t count, size_t capacity, const char *format, va_list arguments)
+    {
+        // Keeps the first offset characters and formats after them; the current buffer stays intact until formatting is complete, since arguments may point into it
+
+        char *data = AllocateBuffer(this, capacity + 1);
+        memcpy(data, this->data, offset);
+
+        try
+        {
+            FormatInto(data + offset, count + 1, format, arguments, "AppendFormat");
+        }
+        catch (...)
+        {
+            if (!this->IsArenaAllocated())
+                free(data);
+            throw;
+        }
+
+        this->Deallocate();
+        this->data = data;
+        this->capacity = capacity;
+        this->length = offset + count;
+        this->data[this->length] = '\0';
     }
 
     // Insert into string
     
     void String::Insert(const String *str, size_t index, size_t count)
-    { this->Insert(str->data, index, count); }
+    {
+        if (count == 0 || count > str->length)
+            count = str->length;
+        this->InsertData(str->data, index, count);
+    }
 
     void String::Insert(const char *str, size_t index, size_t count)
     {
         if (count == 0)
             count = strlen(str);
-            
-        size_t length = strlen(this->data);
+        this->InsertData(str, index, count);
+    }
+
+    void String::InsertData(const char *str, size_t index, size_t count)
+    {
+        this->BeginModification("Insert");
+
+        size_t length = this->length;
         if (index > length)
             throw Error::IndexError("String", "Insert", index, length);
 
-        length += count;
+        // Inserting part of this string into itself must survive the buffer moving and the tail shifting
 
-        char *buffer = (char *)malloc(length + count + 1);
-        memcpy(buffer, this->data, index);
-        memcpy(buffer + index, str, count);
-        strcpy(buffer + index + count, this->data + index);
-        
-        this->Assign(buffer);
-        free(buffer);
+        bool aliased = str >= this->data && str < this->data + length;
+        size_t offset = aliased ? str - this->data : 0;
+
+        this->Resize(length + count);
+        memmove(this->data + index + count, this->data + index, length - index);
+
+        if (!aliased)
+            memcpy(this->data + index, str, count);
+        else if (offset + count <= index)
+            memcpy(this->data + index, this->data + offset, count);
+        else if (offset >= index)
+            memcpy(this->data + index, this->data + offset + count, count);
+        else
+        {
+            size_t head = index - offset;
+            memcpy(this->data + index, this->data + offset, head);
+            memcpy(this->data + index + head, this->data + index + count, count - head);
+        }
     }
 
     // Case conversion
 
     void String::ConvertToUppercase()
     {
-        size_t length = this->Length();
-        for (size_t i = 0; i < length; i++)
-        {
-            char &c = this->GetCharacter(i);
-            if (c >= 'a' && c <= 'z')
-                c -= 0x20;
-        }
+        this->BeginModification("ConvertToUppercase");
+        StringKernels::ConvertToUppercase(this->data, this->length);
     }
 
     void String::ConvertToLowercase()
     {
-        size_t length = this->Length();
-        for (size_t i = 0; i < length; i++)
-        {
-            char &c = this->GetCharacter(i);
-            if (c >= 'A' && c <= 'Z')
-                c += 0x20;
-        }
+        this->BeginModification("ConvertToLowercase");
+        StringKernels::ConvertToLowercase(this->data, this->length);
     }
 }
\ No newline at end of file
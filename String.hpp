@@ -1,16 +1,63 @@
 #pragma once
 
+#include <atomic>
+#include <cstdarg>
+
 using size_t = decltype(sizeof(1));
 
 namespace Scoop::Memory
 {
+    class StringTable;
+
     class String : public Object
     {
+        friend class StringTable;
+
         private:
-            char *data = nullptr;
+            // Strings of up to InlineCapacity characters are stored inline, without a separate allocation
+
+            static constexpr size_t InlineCapacity = 22;
+
+            char *data = inlineData;
+            size_t length = 0;
+            size_t capacity = InlineCapacity;
+            char inlineData[InlineCapacity + 1] = { };
+
+            // Set when data is a private, copy-on-write mapping of a file
+
+            bool mapped = false;
+
+            // Set once the string is interned by a StringTable, after which it can no longer be modified; table is cleared if the table is destroyed first
+
+            bool interned = false;
+            StringTable *table = nullptr;
+
+            // Hash of the contents, computed on first use; 0 until then, and again after any modification
+
+            mutable std::atomic<size_t> hash { 0 };
+
+            void BeginModification(const char *methodName);
+
+            void Deallocate();
+
+            void Reallocate(size_t capacity);
             void Resize(size_t length);
 
+            // Results of up to FormatBufferSize - 1 characters are formatted on the stack, then copied
+
+            static constexpr size_t FormatBufferSize = 256;
+
+            static size_t FormatInto(char *buffer, size_t size, const char *format, va_list arguments, const char *methodName);
+            void FormatIntoNewBuffer(size_t offset, size_t count, size_t capacity, const char *format, va_list arguments);
+
+            size_t FindData(const char *data, size_t length, size_t startIndex, const char *methodName) const;
+            size_t CountData(const char *data, size_t length) const;
+            size_t ReplaceData(const char *target, size_t targetLength, const char *replacement, size_t replacementLength);
+            int CompareIgnoringCaseData(const char *data, size_t length) const;
+
         public:
+            static constexpr size_t NotFound = (size_t)-1;
+
             String();
             ~String();
 
@@ -18,6 +65,12 @@ namespace Scoop::Memory
 
             size_t Length() const;
 
+            // Capacity
+
+            size_t Capacity() const;
+            void Reserve(size_t capacity);
+            void ShrinkToFit();
+
             // Data access
 
             char &GetCharacter(size_t index);
@@ -28,6 +81,10 @@ namespace Scoop::Memory
             bool Empty() const;
             static bool IsNullOrEmpty(const String *string);
 
+            // Interning
+
+            bool IsInterned() const;
+
             // Copy
 
             void Copy(const String *string);
@@ -41,16 +98,23 @@ namespace Scoop::Memory
 
             void Assign(const String *source, size_t startIndex = 0, size_t length = 0);
             void Assign(const char *source, size_t startIndex = 0, size_t length = 0);
+            void AssignData(const char *data, size_t length);
 
             // Format assignment
 
             void AssignFormat(const char *format, ...);
+            void AssignFormatV(const char *format, va_list arguments);
 
             // Assign from file
 
             void AssignFromFile(const String *path);
             void AssignFromFile(const char *path);
 
+            // Map file
+
+            void MapFromFile(const String *path);
+            void MapFromFile(const char *path);
+
             // String comparison
 
             bool IsEqual(const String *string) const;
@@ -58,6 +122,18 @@ namespace Scoop::Memory
             int Compare(const String *string, size_t maxLength = 0) const;
             int Compare(const char *string, size_t maxLength = 0) const;
 
+            // Case-insensitive comparison, for ASCII letters
+
+            bool IsEqualIgnoringCase(const String *string) const;
+            bool IsEqualIgnoringCase(const char *string) const;
+            int CompareIgnoringCase(const String *string) const;
+            int CompareIgnoringCase(const char *string) const;
+
+            // Hashing
+
+            size_t Hash() const;
+            static size_t Hash(const char *data, size_t length);
+
             // Affix testing
 
             bool StartsWith(const String *string) const;
@@ -65,6 +141,22 @@ namespace Scoop::Memory
             bool EndsWith(const String *string) const;
             bool EndsWith(const char *string) const;
 
+            // Searching
+
+            size_t Find(const String *string, size_t startIndex = 0) const;
+            size_t Find(const char *string, size_t startIndex = 0) const;
+            size_t FindLast(const String *string) const;
+            size_t FindLast(const char *string) const;
+            bool Contains(const String *string) const;
+            bool Contains(const char *string) const;
+            size_t Count(const String *string) const;
+            size_t Count(const char *string) const;
+
+            // Replacement
+
+            size_t Replace(const String *target, const String *replacement);
+            size_t Replace(const char *target, const char *replacement);
+
             // Clear string
 
             void Clear();
@@ -74,12 +166,15 @@ namespace Scoop::Memory
             void Append(char c);
             void Append(const String *string, size_t count = 0);
             void Append(const char *string, size_t count = 0);
+            void AppendData(const char *data, size_t length);
             void AppendFormat(const char *format, ...);
+            void AppendFormatV(const char *format, va_list arguments);
 
             // Insert into string
             
             void Insert(const String *string, size_t index, size_t count = 0);
             void Insert(const char *string, size_t index, size_t count = 0);
+            void InsertData(const char *data, size_t index, size_t count);
 
             // Case conversion
 
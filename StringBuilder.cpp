@@ -0,0 +1,227 @@
+#include "StringBuilder.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace Scoop::Memory
+{
+    // Destructor
+
+    StringBuilder::~StringBuilder() = default;
+
+    // Length
+
+    size_t StringBuilder::Length() const
+    { return this->length; }
+
+    bool StringBuilder::Empty() const
+    { return this->length == 0; }
+
+    // Chunk allocation
+
+    StringBuilder::Chunk &StringBuilder::ReserveChunk(size_t length)
+    {
+        // Returns a chunk with room for length more characters and a null terminator, starting a new chunk if the last one is too full
+
+        if (!this->chunks.empty())
+        {
+            Chunk &last = this->chunks.back();
+            if (last.capacity - last.length >= length)
+                return last;
+        }
+
+        size_t capacity = this->chunks.empty() ? FirstChunkCapacity : this->chunks.back().capacity * 2;
+        if (capacity > MaxChunkCapacity)
+            capacity = MaxChunkCapacity;
+        if (capacity < length)
+            capacity = length;
+
+        this->chunks.push_back({ std::unique_ptr<char[]>(new char[capacity + 1]), 0, capacity });
+        return this->chunks.back();
+    }
+
+    // Appending
+
+    void StringBuilder::Append(char c)
+    {
+        Chunk &chunk = this->ReserveChunk(1);
+        chunk.data[chunk.length++] = c;
+        this->length++;
+    }
+
+    void StringBuilder::Append(const String *string)
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringBuilder", "Append", "string");
+        this->AppendData(string->CString(), string->Length());
+    }
+
+    void StringBuilder::Append(const char *string)
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringBuilder", "Append", "string");
+        this->AppendData(string, strlen(string));
+    }
+
+    void StringBuilder::Append(std::string_view string)
+    { this->AppendData(string.data(), string.length()); }
+
+    void StringBuilder::AppendData(const char *data, size_t length)
+    {
+        if (data == nullptr && length != 0)
+            throw Error::NullError("StringBuilder", "AppendData", "data");
+
+        // Fill the rest of the last chunk first, then put the remainder in a single new chunk
+
+        if (!this->chunks.empty())
+        {
+            Chunk &last = this->chunks.back();
+            size_t count = last.capacity - last.length < length ? last.capacity - last.length : length;
+
+            memcpy(last.data.get() + last.length, data, count);
+            last.length += count;
+            this->length += count;
+            data += count;
+            length -= count;
+        }
+
+        if (length == 0)
+            return;
+
+        Chunk &chunk = this->ReserveChunk(length);
+        memcpy(chunk.data.get() + chunk.length, data, length);
+        chunk.length += length;
+        this->length += length;
+    }
+
+    // Format appending
+
+    void StringBuilder::AppendFormat(const char *format, ...)
+    {
+        va_list arguments;
+        va_start(arguments, format);
+
+        try { this->AppendFormatV(format, arguments); }
+        catch (...)
+        {
+            va_end(arguments);
+            throw;
+        }
+
+        va_end(arguments);
+    }
+
+    void StringBuilder::AppendFormatV(const char *format, va_list arguments)
+    {
+        if (format == nullptr)
+            throw Error::NullError("StringBuilder", "AppendFormat", "format");
+
+        // Format straight into the last chunk; only if it does not fit, start a chunk large enough and format again
+
+        Chunk *chunk = &this->ReserveChunk(0);
+        size_t spare = chunk->capacity - chunk->length;
+
+        va_list copy;
+        va_copy(copy, arguments);
+        int count = vsnprintf(chunk->data.get() + chunk->length, spare + 1, format, copy);
+        va_end(copy);
+
+        if (count < 0)
+            throw Error::Create("StringBuilder", "AppendFormat", "Failed to format string '%s'.", format);
+
+        if ((size_t)count > spare)
+        {
+            chunk = &this->ReserveChunk(count);
+            vsnprintf(chunk->data.get() + chunk->length, count + 1, format, arguments);
+        }
+
+        chunk->length += count;
+        this->length += count;
+    }
+
+    // Clear builder
+
+    void StringBuilder::Clear()
+    {
+        this->chunks.clear();
+        this->length = 0;
+    }
+
+    // Materialization
+
+    String *StringBuilder::ToString() const
+    {
+        String *string = new String();
+        string->Reserve(this->length);
+
+        for (const Chunk &chunk : this->chunks)
+            string->AppendData(chunk.data.get(), chunk.length);
+
+        return string;
+    }
+
+    // Chunks
+
+    size_t StringBuilder::ChunkCount() const
+    { return this->chunks.size(); }
+
+#ifndef _WIN32
+    // Scatter-gather output
+
+    void StringBuilder::GetChunks(std::vector<iovec> *chunks) const
+    {
+        if (chunks == nullptr)
+            throw Error::NullError("StringBuilder", "GetChunks", "chunks");
+
+        chunks->clear();
+        chunks->reserve(this->chunks.size());
+
+        for (const Chunk &chunk : this->chunks)
+        {
+            if (chunk.length != 0)
+                chunks->push_back({ chunk.data.get(), chunk.length });
+        }
+    }
+
+    void StringBuilder::WriteTo(int fileDescriptor) const
+    {
+        std::vector<iovec> chunks;
+        this->GetChunks(&chunks);
+
+        // writev takes at most IOV_MAX chunks and may write only part of them, so continue from wherever it stopped
+
+        iovec *next = chunks.data(), *end = chunks.data() + chunks.size();
+        while (next != end)
+        {
+            int count = end - next < IOV_MAX ? (int)(end - next) : IOV_MAX;
+            ssize_t written = writev(fileDescriptor, next, count);
+
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw Error::Create("StringBuilder", "WriteTo", "Failed to write to file descriptor %d: %s.", fileDescriptor, strerror(errno));
+            }
+
+            size_t remaining = (size_t)written;
+            while (next != end && remaining >= next->iov_len)
+            {
+                remaining -= next->iov_len;
+                next++;
+            }
+
+            if (remaining != 0)
+            {
+                next->iov_base = (char *)next->iov_base + remaining;
+                next->iov_len -= remaining;
+            }
+        }
+    }
+#endif
+}
\ No newline at end of file
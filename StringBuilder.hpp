@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdarg>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+namespace Scoop::Memory
+{
+    class StringBuilder : public Object
+    {
+        private:
+            // Appended data fills a list of chunks that are never moved or copied; each new chunk is larger than the last, up to MaxChunkCapacity
+
+            static constexpr size_t FirstChunkCapacity = 256;
+            static constexpr size_t MaxChunkCapacity = 1024 * 1024;
+
+            struct Chunk
+            {
+                std::unique_ptr<char[]> data;
+                size_t length;
+                size_t capacity;
+            };
+
+            std::vector<Chunk> chunks;
+            size_t length = 0;
+
+            Chunk &ReserveChunk(size_t length);
+
+        public:
+            StringBuilder() = default;
+            ~StringBuilder();
+
+            // Length
+
+            size_t Length() const;
+            bool Empty() const;
+
+            // Appending
+
+            void Append(char c);
+            void Append(const String *string);
+            void Append(const char *string);
+            void Append(std::string_view string);
+            void AppendData(const char *data, size_t length);
+
+            // Format appending
+
+            void AppendFormat(const char *format, ...);
+            void AppendFormatV(const char *format, va_list arguments);
+
+            // Clear builder
+
+            void Clear();
+
+            // Materialization; the caller owns the returned reference
+
+            String *ToString() const;
+
+            // Chunks
+
+            size_t ChunkCount() const;
+
+#ifndef _WIN32
+            // Scatter-gather output, without concatenating the chunks
+
+            void GetChunks(std::vector<iovec> *chunks) const;
+            void WriteTo(int fileDescriptor) const;
+#endif
+    };
+}
\ No newline at end of file
@@ -0,0 +1,456 @@
+#include "StringKernels.hpp"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define SSE2_AVAILABLE
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(SSE2_AVAILABLE) && defined(__GNUC__)
+#define AVX2_AVAILABLE
+#include <immintrin.h>
+#endif
+
+namespace Scoop::Memory::StringKernels
+{
+    // Scalar kernels, which also finish the bytes that do not fill a whole vector
+
+    static char ToLowercase(char c)
+    { return c >= 'A' && c <= 'Z' ? (char)(c + 0x20) : c; }
+
+    static const char *ScalarFind(const char *data, size_t length, const char *needle, size_t needleLength)
+    {
+        if (needleLength == 0)
+            return data;
+        if (needleLength > length)
+            return nullptr;
+
+        char first = needle[0], last = needle[needleLength - 1];
+        for (size_t i = 0, limit = length - needleLength + 1; i < limit; i++)
+        {
+            if (data[i] == first && data[i + needleLength - 1] == last && memcmp(data + i + 1, needle + 1, needleLength - 1) == 0)
+                return data + i;
+        }
+
+        return nullptr;
+    }
+
+    static const char *ScalarFindLast(const char *data, size_t length, const char *needle, size_t needleLength)
+    {
+        if (needleLength == 0)
+            return data + length;
+        if (needleLength > length)
+            return nullptr;
+
+        char first = needle[0], last = needle[needleLength - 1];
+        for (size_t i = length - needleLength + 1; i-- > 0; )
+        {
+            if (data[i] == first && data[i + needleLength - 1] == last && memcmp(data + i + 1, needle + 1, needleLength - 1) == 0)
+                return data + i;
+        }
+
+        return nullptr;
+    }
+
+    static void ScalarConvertToUppercase(char *data, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            if (data[i] >= 'a' && data[i] <= 'z')
+                data[i] -= 0x20;
+        }
+    }
+
+    static void ScalarConvertToLowercase(char *data, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            if (data[i] >= 'A' && data[i] <= 'Z')
+                data[i] += 0x20;
+        }
+    }
+
+    static int ScalarCompareIgnoringCase(const char *first, const char *second, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            unsigned char a = (unsigned char)ToLowercase(first[i]), b = (unsigned char)ToLowercase(second[i]);
+            if (a != b)
+                return a - b;
+        }
+
+        return 0;
+    }
+
+#ifdef SSE2_AVAILABLE
+    // Positions of the lowest and highest set bits of a nonzero match mask
+
+    static unsigned LowestSetBit(unsigned mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (unsigned)index;
+#else
+        return (unsigned)__builtin_ctz(mask);
+#endif
+    }
+
+    static unsigned HighestSetBit(unsigned mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse(&index, mask);
+        return (unsigned)index;
+#else
+        return 31 - (unsigned)__builtin_clz(mask);
+#endif
+    }
+
+    // SSE2 kernels, 16 bytes at a time
+
+    static const char *SSE2Find(const char *data, size_t length, const char *needle, size_t needleLength)
+    {
+        if (needleLength == 0)
+            return data;
+        if (needleLength > length)
+            return nullptr;
+
+        // Test 16 candidate positions at once against the first and last bytes of the needle, then compare the rest
+
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[needleLength - 1]);
+        size_t limit = length - needleLength + 1, i = 0;
+
+        for (; i + 16 <= limit; i += 16)
+        {
+            __m128i blockFirst = _mm_loadu_si128((const __m128i *)(data + i));
+            __m128i blockLast = _mm_loadu_si128((const __m128i *)(data + i + needleLength - 1));
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)));
+
+            for (; mask != 0; mask &= mask - 1)
+            {
+                const char *candidate = data + i + LowestSetBit(mask);
+                if (memcmp(candidate + 1, needle + 1, needleLength - 1) == 0)
+                    return candidate;
+            }
+        }
+
+        return ScalarFind(data + i, length - i, needle, needleLength);
+    }
+
+    static const char *SSE2FindLast(const char *data, size_t length, const char *needle, size_t needleLength)
+    {
+        if (needleLength == 0)
+            return data + length;
+        if (needleLength > length)
+            return nullptr;
+
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[needleLength - 1]);
+        size_t i = length - needleLength + 1;
+
+        for (; i >= 16; i -= 16)
+        {
+            __m128i blockFirst = _mm_loadu_si128((const __m128i *)(data + i - 16));
+            __m128i blockLast = _mm_loadu_si128((const __m128i *)(data + i - 16 + needleLength - 1));
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)));
+
+            while (mask != 0)
+            {
+                unsigned bit = HighestSetBit(mask);
+                const char *candidate = data + i - 16 + bit;
+                if (memcmp(candidate + 1, needle + 1, needleLength - 1) == 0)
+                    return candidate;
+
+                mask &= ~(1u << bit);
+            }
+        }
+
+        return ScalarFindLast(data, i + needleLength - 1, needle, needleLength);
+    }
+
+    static __m128i SSE2InRange(__m128i block, char lowest, char count)
+    {
+        // Shift the range to the bottom of the signed byte range, so that one signed comparison tests both bounds
+
+        __m128i shifted = _mm_add_epi8(block, _mm_set1_epi8((char)(-128 - lowest)));
+        return _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(-128 + count)));
+    }
+
+    static void SSE2ConvertCase(char *data, size_t length, char lowest)
+    {
+        const __m128i flip = _mm_set1_epi8(0x20);
+        size_t i = 0;
+
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+            block = _mm_xor_si128(block, _mm_and_si128(SSE2InRange(block, lowest, 26), flip));
+            _mm_storeu_si128((__m128i *)(data + i), block);
+        }
+
+        if (lowest == 'a')
+            ScalarConvertToUppercase(data + i, length - i);
+        else
+            ScalarConvertToLowercase(data + i, length - i);
+    }
+
+    static void SSE2ConvertToUppercase(char *data, size_t length)
+    { SSE2ConvertCase(data, length, 'a'); }
+
+    static void SSE2ConvertToLowercase(char *data, size_t length)
+    { SSE2ConvertCase(data, length, 'A'); }
+
+    static int SSE2CompareIgnoringCase(const char *first, const char *second, size_t length)
+    {
+        const __m128i flip = _mm_set1_epi8(0x20);
+        size_t i = 0;
+
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i *)(first + i));
+            __m128i b = _mm_loadu_si128((const __m128i *)(second + i));
+            a = _mm_or_si128(a, _mm_and_si128(SSE2InRange(a, 'A', 26), flip));
+            b = _mm_or_si128(b, _mm_and_si128(SSE2InRange(b, 'A', 26), flip));
+
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+            if (mask != 0xFFFF)
+                return ScalarCompareIgnoringCase(first + i, second + i, 16);
+        }
+
+        return ScalarCompareIgnoringCase(first + i, second + i, length - i);
+    }
+#endif
+
+#ifdef AVX2_AVAILABLE
+    // AVX2 kernels, 32 bytes at a time; compiled for AVX2 regardless of the target, and only called when the processor supports it
+
+    __attribute__((target("avx2"))) static const char *AVX2Find(const char *data, size_t length, const char *needle, size_t needleLength)
+    {
+        if (needleLength == 0)
+            return data;
+        if (needleLength > length)
+            return nullptr;
+
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[needleLength - 1]);
+        size_t limit = length - needleLength + 1, i = 0;
+
+        for (; i + 32 <= limit; i += 32)
+        {
+            __m256i blockFirst = _mm256_loadu_si256((const __m256i *)(data + i));
+            __m256i blockLast = _mm256_loadu_si256((const __m256i *)(data + i + needleLength - 1));
+            unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last)));
+
+            for (; mask != 0; mask &= mask - 1)
+            {
+                const char *candidate = data + i + LowestSetBit(mask);
+                if (memcmp(candidate + 1, needle + 1, needleLength - 1) == 0)
+                    return candidate;
+            }
+        }
+
+        return SSE2Find(data + i, length - i, needle, needleLength);
+    }
+
+    __attribute__((target("avx2"))) static const char *AVX2FindLast(const char *data, size_t length, const char *needle, size_t needleLength)
+    {
+        if (needleLength == 0)
+            return data + length;
+        if (needleLength > length)
+            return nullptr;
+
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[needleLength - 1]);
+        size_t i = length - needleLength + 1;
+
+        for (; i >= 32; i -= 32)
+        {
+            __m256i blockFirst = _mm256_loadu_si256((const __m256i *)(data + i - 32));
+            __m256i blockLast = _mm256_loadu_si256((const __m256i *)(data + i - 32 + needleLength - 1));
+            unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last)));
+
+            while (mask != 0)
+            {
+                unsigned bit = HighestSetBit(mask);
+                const char *candidate = data + i - 32 + bit;
+                if (memcmp(candidate + 1, needle + 1, needleLength - 1) == 0)
+                    return candidate;
+
+                mask &= ~(1u << bit);
+            }
+        }
+
+        return SSE2FindLast(data, i + needleLength - 1, needle, needleLength);
+    }
+
+    __attribute__((target("avx2"))) static __m256i AVX2InRange(__m256i block, char lowest, char count)
+    {
+        __m256i shifted = _mm256_add_epi8(block, _mm256_set1_epi8((char)(-128 - lowest)));
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + count)), shifted);
+    }
+
+    __attribute__((target("avx2"))) static void AVX2ConvertCase(char *data, size_t length, char lowest)
+    {
+        const __m256i flip = _mm256_set1_epi8(0x20);
+        size_t i = 0;
+
+        for (; i + 32 <= length; i += 32)
+        {
+            __m256i block = _mm256_loadu_si256((const __m256i *)(data + i));
+            block = _mm256_xor_si256(block, _mm256_and_si256(AVX2InRange(block, lowest, 26), flip));
+            _mm256_storeu_si256((__m256i *)(data + i), block);
+        }
+
+        SSE2ConvertCase(data + i, length - i, lowest);
+    }
+
+    static void AVX2ConvertToUppercase(char *data, size_t length)
+    { AVX2ConvertCase(data, length, 'a'); }
+
+    static void AVX2ConvertToLowercase(char *data, size_t length)
+    { AVX2ConvertCase(data, length, 'A'); }
+
+    __attribute__((target("avx2"))) static int AVX2CompareIgnoringCase(const char *first, const char *second, size_t length)
+    {
+        const __m256i flip = _mm256_set1_epi8(0x20);
+        size_t i = 0;
+
+        for (; i + 32 <= length; i += 32)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(first + i));
+            __m256i b = _mm256_loadu_si256((const __m256i *)(second + i));
+            a = _mm256_or_si256(a, _mm256_and_si256(AVX2InRange(a, 'A', 26), flip));
+            b = _mm256_or_si256(b, _mm256_and_si256(AVX2InRange(b, 'A', 26), flip));
+
+            unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+            if (mask != 0xFFFFFFFF)
+                return ScalarCompareIgnoringCase(first + i, second + i, 32);
+        }
+
+        return SSE2CompareIgnoringCase(first + i, second + i, length - i);
+    }
+#endif
+
+    // Dispatch
+
+    struct Kernels
+    {
+        const char *(*find)(const char *, size_t, const char *, size_t);
+        const char *(*findLast)(const char *, size_t, const char *, size_t);
+        void (*convertToUppercase)(char *, size_t);
+        void (*convertToLowercase)(char *, size_t);
+        int (*compareIgnoringCase)(const char *, const char *, size_t);
+    };
+
+    static const Kernels ScalarKernels = { ScalarFind, ScalarFindLast, ScalarConvertToUppercase, ScalarConvertToLowercase, ScalarCompareIgnoringCase };
+#ifdef SSE2_AVAILABLE
+    static const Kernels SSE2Kernels = { SSE2Find, SSE2FindLast, SSE2ConvertToUppercase, SSE2ConvertToLowercase, SSE2CompareIgnoringCase };
+#endif
+#ifdef AVX2_AVAILABLE
+    static const Kernels AVX2Kernels = { AVX2Find, AVX2FindLast, AVX2ConvertToUppercase, AVX2ConvertToLowercase, AVX2CompareIgnoringCase };
+#endif
+
+    static const Kernels &KernelsFor(InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+#ifdef AVX2_AVAILABLE
+            case InstructionSet::AVX2:
+                return AVX2Kernels;
+#endif
+#ifdef SSE2_AVAILABLE
+            case InstructionSet::SSE2:
+                return SSE2Kernels;
+#endif
+            default:
+                return ScalarKernels;
+        }
+    }
+
+    static InstructionSet BestInstructionSet()
+    {
+        if (IsSupported(InstructionSet::AVX2))
+            return InstructionSet::AVX2;
+        if (IsSupported(InstructionSet::SSE2))
+            return InstructionSet::SSE2;
+
+        return InstructionSet::Scalar;
+    }
+
+    static std::atomic<InstructionSet> &CurrentInstructionSet()
+    {
+        static std::atomic<InstructionSet> current(BestInstructionSet());
+        return current;
+    }
+
+    static const Kernels &Current()
+    { return KernelsFor(CurrentInstructionSet().load(std::memory_order_relaxed)); }
+
+    InstructionSet GetInstructionSet()
+    { return CurrentInstructionSet().load(std::memory_order_relaxed); }
+
+    bool IsSupported(InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+            case InstructionSet::Scalar:
+                return true;
+#ifdef SSE2_AVAILABLE
+            case InstructionSet::SSE2:
+                return true;
+#endif
+#ifdef AVX2_AVAILABLE
+            case InstructionSet::AVX2:
+                return __builtin_cpu_supports("avx2");
+#endif
+            default:
+                return false;
+        }
+    }
+
+    void SetInstructionSet(InstructionSet instructionSet)
+    {
+        if (!IsSupported(instructionSet))
+            throw Error::Create("StringKernels", "SetInstructionSet", "Instruction set %s is not supported.", InstructionSetName(instructionSet));
+
+        CurrentInstructionSet().store(instructionSet, std::memory_order_relaxed);
+    }
+
+    const char *InstructionSetName(InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+            case InstructionSet::SSE2:
+                return "SSE2";
+            case InstructionSet::AVX2:
+                return "AVX2";
+            default:
+                return "scalar";
+        }
+    }
+
+    // Kernels
+
+    const char *Find(const char *data, size_t length, const char *needle, size_t needleLength)
+    { return Current().find(data, length, needle, needleLength); }
+
+    const char *FindLast(const char *data, size_t length, const char *needle, size_t needleLength)
+    { return Current().findLast(data, length, needle, needleLength); }
+
+    void ConvertToUppercase(char *data, size_t length)
+    { Current().convertToUppercase(data, length); }
+
+    void ConvertToLowercase(char *data, size_t length)
+    { Current().convertToLowercase(data, length); }
+
+    int CompareIgnoringCase(const char *first, const char *second, size_t length)
+    { return Current().compareIgnoringCase(first, second, length); }
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Scoop::Memory::StringKernels
+{
+    // Kernels behind String's search, comparison and case conversion, dispatched at runtime to the widest supported instruction set
+
+    enum class InstructionSet
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    InstructionSet GetInstructionSet();
+    bool IsSupported(InstructionSet instructionSet);
+    void SetInstructionSet(InstructionSet instructionSet); // for testing and benchmarking; throws if unsupported
+    const char *InstructionSetName(InstructionSet instructionSet);
+
+    // Searching; returns nullptr if there is no match, and an empty needle matches at the start for Find and at the end for FindLast
+
+    const char *Find(const char *data, size_t length, const char *needle, size_t needleLength);
+    const char *FindLast(const char *data, size_t length, const char *needle, size_t needleLength);
+
+    // ASCII case conversion, in place
+
+    void ConvertToUppercase(char *data, size_t length);
+    void ConvertToLowercase(char *data, size_t length);
+
+    // ASCII case-insensitive comparison of two buffers of equal length; compares bytes as lowercase and unsigned
+
+    int CompareIgnoringCase(const char *first, const char *second, size_t length);
+}
\ No newline at end of file
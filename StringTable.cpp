@@ -0,0 +1,87 @@
+#include "StringTable.hpp"
+
+namespace Scoop::Memory
+{
+    StringTable::~StringTable()
+    {
+        // Strings still referenced elsewhere outlive the table, and stay immutable
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (const auto &entry : this->strings)
+            entry.second->table = nullptr;
+    }
+
+    // Shared table
+
+    StringTable &StringTable::Shared()
+    {
+        static StringTable *table = new StringTable();
+        return *table;
+    }
+
+    // Intern
+
+    String *StringTable::Intern(const char *string)
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringTable", "Intern", "string");
+
+        return this->Intern(std::string_view(string));
+    }
+
+    String *StringTable::Intern(std::string_view string)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        // The string is retained while the table is locked, so that it cannot be destroyed before the caller receives it
+
+        auto iterator = this->strings.find(string);
+        if (iterator != this->strings.end())
+        {
+            if (iterator->second->TryRetain())
+                return iterator->second;
+
+            // The string is being destroyed on another thread; it only removes its entry if the entry still refers to it
+
+            this->strings.erase(iterator);
+        }
+
+        // Interned strings may be shared between threads, so their reference count is atomic
+
+        String *interned = new String();
+        interned->AssignData(string.data(), string.size());
+        interned->SetReferenceCounting(ReferenceCounting::Atomic);
+        interned->interned = true;
+        interned->table = this;
+
+        this->strings.emplace(std::string_view(interned->CString(), interned->Length()), interned);
+        return interned;
+    }
+
+    String *StringTable::Intern(const String *string)
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringTable", "Intern", "string");
+
+        return this->Intern(std::string_view(string->CString(), string->Length()));
+    }
+
+    // Interned string count
+
+    size_t StringTable::Count() const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->strings.size();
+    }
+
+    // Removal, when an interned string is destroyed
+
+    void StringTable::Remove(String *string)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        auto iterator = this->strings.find(std::string_view(string->CString(), string->Length()));
+        if (iterator != this->strings.end() && iterator->second == string)
+            this->strings.erase(iterator);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace Scoop::Memory
+{
+    class StringTable
+    {
+        friend class String;
+
+        private:
+            struct KeyHash
+            {
+                size_t operator()(std::string_view key) const
+                { return String::Hash(key.data(), key.size()); }
+            };
+
+            // Keys view the contents of the interned strings, which never change once interned; the table does not own the strings, and each one removes its entry when it is destroyed
+
+            std::unordered_map<std::string_view, String *, KeyHash> strings;
+            mutable std::mutex mutex;
+
+            void Remove(String *string);
+
+        public:
+            StringTable() = default;
+            ~StringTable();
+
+            // Process-wide table
+
+            static StringTable &Shared();
+
+            // Canonical string for the given contents; the caller owns the returned reference
+
+            String *Intern(const char *string);
+            String *Intern(std::string_view string);
+            String *Intern(const String *string);
+
+            // Interned string count
+
+            size_t Count() const;
+
+            // Prohibit copying
+
+            StringTable(const StringTable &) = delete;
+            void operator=(const StringTable &) = delete;
+
+            // Prohibit moving
+
+            StringTable(StringTable &&) = delete;
+            void operator=(StringTable &&) = delete;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "StringView.hpp"
+
+#include <cstring>
+
+namespace Scoop::Memory
+{
+    // Constructor
+
+    StringView::StringView(String *string)
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringView", "StringView", "string");
+
+        string->Retain();
+        this->parent = string;
+        this->length = string->Length();
+    }
+
+    StringView::StringView(String *string, size_t startIndex, size_t length)
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringView", "StringView", "string");
+        if (startIndex > string->Length())
+            throw Error::IndexError("StringView", "StringView", startIndex, string->Length());
+        if (length > string->Length() - startIndex)
+            throw Error::IndexError("StringView", "StringView", startIndex + length, string->Length());
+
+        string->Retain();
+        this->parent = string;
+        this->startIndex = startIndex;
+        this->length = length;
+    }
+
+    // Destructor
+
+    StringView::~StringView()
+    {
+        if (this->parent != nullptr)
+            this->parent->Release();
+    }
+
+    // Copy
+
+    StringView::StringView(const StringView &other) : parent(other.parent), startIndex(other.startIndex), length(other.length)
+    {
+        if (this->parent != nullptr)
+            this->parent->Retain();
+    }
+
+    StringView &StringView::operator=(const StringView &other)
+    {
+        // Retain first, in case the new parent is only kept alive by the old one
+
+        if (other.parent != nullptr)
+            other.parent->Retain();
+        if (this->parent != nullptr)
+            this->parent->Release();
+
+        this->parent = other.parent;
+        this->startIndex = other.startIndex;
+        this->length = other.length;
+        return *this;
+    }
+
+    // Move
+
+    StringView::StringView(StringView &&other) noexcept : parent(other.parent), startIndex(other.startIndex), length(other.length)
+    {
+        other.parent = nullptr;
+        other.startIndex = 0;
+        other.length = 0;
+    }
+
+    StringView &StringView::operator=(StringView &&other) noexcept
+    {
+        if (this != &other)
+        {
+            String *oldParent = this->parent;
+            this->parent = other.parent;
+            this->startIndex = other.startIndex;
+            this->length = other.length;
+
+            other.parent = nullptr;
+            other.startIndex = 0;
+            other.length = 0;
+
+            if (oldParent != nullptr)
+                oldParent->Release();
+        }
+
+        return *this;
+    }
+
+    // Range
+
+    String *StringView::Parent() const
+    { return this->parent; }
+
+    size_t StringView::StartIndex() const
+    { return this->startIndex; }
+
+    size_t StringView::Length() const
+    { return this->length; }
+
+    bool StringView::Empty() const
+    { return this->length == 0; }
+
+    // Data access
+
+    const char *StringView::Data(const char *methodName) const
+    {
+        if (this->parent == nullptr)
+            return "";
+
+        // The parent may have been modified since the view was created; its contents are read as they are now, but must still cover the range
+
+        if (this->startIndex + this->length > this->parent->Length())
+            throw Error::Create("StringView", methodName, "Parent string was shortened below the end of the view.");
+
+        return this->parent->CString() + this->startIndex;
+    }
+
+    const char *StringView::Data() const
+    { return this->Data("Data"); }
+
+    char StringView::GetCharacter(size_t index) const
+    {
+        if (index >= this->length)
+            throw Error::IndexError("StringView", "GetCharacter", index, this->length);
+        return this->Data("GetCharacter")[index];
+    }
+
+    StringView::operator std::string_view() const
+    { return std::string_view(this->Data("operator std::string_view"), this->length); }
+
+    // Slicing
+
+    StringView StringView::Slice(size_t startIndex, size_t length) const
+    {
+        if (startIndex > this->length)
+            throw Error::IndexError("StringView", "Slice", startIndex, this->length);
+        if (length > this->length - startIndex)
+            throw Error::IndexError("StringView", "Slice", startIndex + length, this->length);
+
+        if (this->parent == nullptr)
+            return StringView();
+
+        return StringView(this->parent, this->startIndex + startIndex, length);
+    }
+
+    // Comparison
+
+    static int CompareData(const char *first, size_t firstLength, const char *second, size_t secondLength)
+    {
+        size_t common = firstLength < secondLength ? firstLength : secondLength;
+
+        int result = memcmp(first, second, common);
+        if (result != 0)
+            return result;
+
+        return firstLength < secondLength ? -1 : firstLength > secondLength ? 1 : 0;
+    }
+
+    bool StringView::IsEqual(const StringView &view) const
+    {
+        if (this->length != view.length)
+            return false;
+        if (this->parent == view.parent && this->startIndex == view.startIndex)
+            return true;
+
+        return memcmp(this->Data("IsEqual"), view.Data("IsEqual"), this->length) == 0;
+    }
+
+    bool StringView::IsEqual(const String *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringView", "IsEqual", "string");
+        return this->length == string->Length() && memcmp(this->Data("IsEqual"), string->CString(), this->length) == 0;
+    }
+
+    bool StringView::IsEqual(const char *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringView", "IsEqual", "string");
+        return this->length == strlen(string) && memcmp(this->Data("IsEqual"), string, this->length) == 0;
+    }
+
+    int StringView::Compare(const StringView &view) const
+    { return CompareData(this->Data("Compare"), this->length, view.Data("Compare"), view.length); }
+
+    int StringView::Compare(const String *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringView", "Compare", "string");
+        return CompareData(this->Data("Compare"), this->length, string->CString(), string->Length());
+    }
+
+    int StringView::Compare(const char *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringView", "Compare", "string");
+        return CompareData(this->Data("Compare"), this->length, string, strlen(string));
+    }
+
+    // Hashing
+
+    size_t StringView::Hash() const
+    {
+        // A view of a whole string shares the string's cached hash
+
+        if (this->parent != nullptr && this->startIndex == 0 && this->length == this->parent->Length())
+            return this->parent->Hash();
+
+        return String::Hash(this->Data("Hash"), this->length);
+    }
+
+    // Affix testing
+
+    bool StringView::StartsWith(const char *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringView", "StartsWith", "string");
+
+        size_t length = strlen(string);
+        return length <= this->length && memcmp(this->Data("StartsWith"), string, length) == 0;
+    }
+
+    bool StringView::EndsWith(const char *string) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringView", "EndsWith", "string");
+
+        size_t length = strlen(string);
+        return length <= this->length && memcmp(this->Data("EndsWith") + this->length - length, string, length) == 0;
+    }
+
+    // Searching
+
+    size_t StringView::Find(const char *string, size_t startIndex) const
+    {
+        if (string == nullptr)
+            throw Error::NullError("StringView", "Find", "string");
+        if (startIndex > this->length)
+            throw Error::IndexError("StringView", "Find", startIndex, this->length);
+
+        const char *data = this->Data("Find");
+        const char *match = StringKernels::Find(data + startIndex, this->length - startIndex, string, strlen(string));
+        return match != nullptr ? match - data : String::NotFound;
+    }
+
+    size_t StringView::Find(char c, size_t startIndex) const
+    {
+        if (startIndex > this->length)
+            throw Error::IndexError("StringView", "Find", startIndex, this->length);
+
+        const char *data = this->Data("Find");
+        const char *match = (const char *)memchr(data + startIndex, c, this->length - startIndex);
+        return match != nullptr ? match - data : String::NotFound;
+    }
+
+    // Materialization
+
+    String *StringView::ToString() const
+    {
+        String *string = new String();
+        string->AssignData(this->Data("ToString"), this->length);
+        return string;
+    }
+}
\ No newline at end of file
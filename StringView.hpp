@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string_view>
+
+namespace Scoop::Memory
+{
+    class StringView
+    {
+        private:
+            // Refers to a range of the parent, which it retains; the range is checked against the parent on every access
+
+            String *parent = nullptr;
+            size_t startIndex = 0;
+            size_t length = 0;
+
+            const char *Data(const char *methodName) const;
+
+        public:
+            StringView() = default;
+            ~StringView();
+
+            // View of a whole string, or of length characters starting at startIndex
+
+            explicit StringView(String *string);
+            StringView(String *string, size_t startIndex, size_t length);
+
+            // Copying retains the parent
+
+            StringView(const StringView &other);
+            StringView &operator=(const StringView &other);
+
+            // Moving transfers the reference without retaining or releasing
+
+            StringView(StringView &&other) noexcept;
+            StringView &operator=(StringView &&other) noexcept;
+
+            // Range
+
+            String *Parent() const;
+            size_t StartIndex() const;
+            size_t Length() const;
+            bool Empty() const;
+
+            // Data access; the data is not null-terminated
+
+            const char *Data() const;
+            char GetCharacter(size_t index) const;
+            operator std::string_view() const;
+
+            // Narrower view of the same parent, relative to this view
+
+            StringView Slice(size_t startIndex, size_t length) const;
+
+            // Comparison
+
+            bool IsEqual(const StringView &view) const;
+            bool IsEqual(const String *string) const;
+            bool IsEqual(const char *string) const;
+            int Compare(const StringView &view) const;
+            int Compare(const String *string) const;
+            int Compare(const char *string) const;
+
+            // Hashing; matches String::Hash for equal contents
+
+            size_t Hash() const;
+
+            // Affix testing
+
+            bool StartsWith(const char *string) const;
+            bool EndsWith(const char *string) const;
+
+            // Searching, relative to this view
+
+            size_t Find(const char *string, size_t startIndex = 0) const;
+            size_t Find(char c, size_t startIndex = 0) const;
+
+            // Materialize an owning copy; the caller owns the returned reference
+
+            String *ToString() const;
+    };
+}
\ No newline at end of file
@@ -1,11 +1,61 @@
 #include "Tests.hpp"
 
 #include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <new>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 #define BEGIN_TEST(section) size_t pass = 0, fail = 0; const char *_section = section; printf("Beginning tests for %s...\n", _section);
 #define TEST(test, condition, failMessage) if (condition) { pass++; } else { printf("[%s] Fail: %s\n", test, failMessage); fail++; }
 #define END_TEST { printf("All tests complete for %s. Passed %zu/%zu tests.\n", _section, pass, pass + fail); }
 
+// Counts the heap allocations made by each thread, so that tests can assert an operation does not allocate. Replacing the
+// global allocation functions affects the whole program, so it is only done when the test binary defines
+// SCOOP_MEMORY_COUNT_ALLOCATIONS
+
+#ifdef SCOOP_MEMORY_COUNT_ALLOCATIONS
+static thread_local size_t allocationCount = 0;
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+NOINLINE void *operator new(size_t size)
+{
+    allocationCount++;
+
+    void *ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+NOINLINE void operator delete(void *ptr) noexcept
+{ free(ptr); }
+
+NOINLINE void operator delete(void *ptr, size_t) noexcept
+{ free(ptr); }
+#endif
+
+// Writes contents to a new temporary file and stores its path
+
+static void WriteTemporaryFile(const char *contents, size_t length, char (&path)[64])
+{
+    strcpy(path, "/tmp/ScoopMemoryTest.XXXXXX");
+
+    int file = mkstemp(path);
+    if (file < 0 || write(file, contents, length) != (ssize_t)length)
+        throw Error::Create("TestScoopMemory", "WriteTemporaryFile", "Failed to write temporary file.");
+
+    close(file);
+}
+
 namespace Scoop::Memory::TestScoopMemory
 {
     void TestObject()
@@ -35,6 +85,40 @@ namespace Scoop::Memory::TestScoopMemory
         obj->Release();
         TEST("Object::~Object", didDelete, "object did not delete upon final release.");
 
+        Object *defaultObj = new Object();
+        TEST("Object::GetReferenceCounting", defaultObj->GetReferenceCounting() == DefaultReferenceCounting, "default mode was not used.");
+        defaultObj->Release();
+
+        // Multi-threaded stress test
+
+        didDelete = false;
+        ThreadSafe<TestObject> *shared = new ThreadSafe<TestObject>(didDelete);
+        TEST("ThreadSafe::ThreadSafe", shared->GetReferenceCounting() == ReferenceCounting::Atomic, "reference counting is not atomic.");
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < 8; i++)
+        {
+            shared->Retain();
+            threads.emplace_back([shared]()
+            {
+                for (size_t j = 0; j < 100000; j++)
+                {
+                    shared->Retain();
+                    shared->Release();
+                }
+
+                shared->Release();
+            });
+        }
+
+        for (std::thread &thread : threads)
+            thread.join();
+
+        TEST("Object::Retain", shared->GetReferenceCount() == 1, "concurrent retains and releases were lost.");
+        TEST("Object::~Object", didDelete == false, "object deleted prematurely.");
+        shared->Release();
+        TEST("Object::~Object", didDelete, "object did not delete upon final release.");
+
         END_TEST;
     }
 
@@ -102,17 +186,457 @@ namespace Scoop::Memory::TestScoopMemory
         otherString->AppendFormat("a %d, b %s", 3, "hi");
         TEST("String::AppendFormat", otherString->EndsWith("a 3, b hi"), "did not append format.");
 
+        String *formatted = new String();
+        formatted->AppendFormat("%s", "inline");
+        formatted->AppendFormat(" %0500d", 7);
+        TEST("String::AppendFormat", formatted->Length() == 507 && formatted->StartsWith("inline 000") && formatted->EndsWith("007"), "did not grow to fit formatted output.");
+        formatted->AssignFormat("%d-%d", 1, 2);
+        TEST("String::AssignFormat", formatted->IsEqual("1-2"), "did not replace previous contents.");
+
+        // Arguments may point into the string being formatted, both when the result is short and when the buffer grows
+
+        formatted->AssignFormat("[%s]", formatted->CString());
+        TEST("String::AssignFormat", formatted->IsEqual("[1-2]"), "argument pointing into the string was overwritten.");
+
+        std::vector<char> padding(300, 'p');
+        padding.push_back('\0');
+        formatted->AssignData(padding.data(), 300);
+        formatted->AppendFormat("%s|%s", formatted->CString(), formatted->CString());
+        TEST("String::AppendFormat", formatted->Length() == 901 && formatted->CString()[600] == '|' && formatted->EndsWith("ppp"), "argument pointing into the growing string was overwritten.");
+
+        formatted->AssignFormat("%s%s", formatted->CString(), formatted->CString() + 600);
+        TEST("String::AssignFormat", formatted->Length() == 901 + 301 && formatted->CString()[600] == '|' && formatted->CString()[901] == '|', "argument pointing into the string was overwritten.");
+
+        formatted->Reserve(5000);
+        formatted->AppendFormat("%s", formatted->CString());
+        TEST("String::AppendFormat", formatted->Length() == 2404 && formatted->CString()[1202 + 600] == '|' && formatted->Capacity() == 5000, "argument pointing into the string was overwritten within spare capacity.");
+        formatted->Release();
+
+        bool threw = false;
+        try { throw Error::Create("Class", "Method", "Value %d is %s.", 3, "wrong"); }
+        catch (const std::runtime_error &error) { threw = strcmp(error.what(), "[Class::Method] Value 3 is wrong.") == 0; }
+        TEST("Error::Create", threw, "did not format the error message.");
+
         string->ConvertToUppercase();
         TEST("String::ConvertToUppercase", string->IsEqual("HELLO"), "did not convert to uppercase.");
         string->ConvertToLowercase();
         TEST("String::ConvertToLowercase", string->IsEqual("hello"), "did not convert to lowercase.");
 
+        // Cached length and embedded null bytes
+
+        otherString->AssignData("a\0b", 3);
+        TEST("String::AssignData", otherString->Length() == 3 && otherString->GetCharacter(2) == 'b', "embedded null byte truncated the string.");
+        otherString->AppendData("\0c", 2);
+        TEST("String::AppendData", otherString->Length() == 5 && otherString->GetCharacter(4) == 'c', "embedded null byte truncated the appended data.");
+        string->Copy(otherString);
+        TEST("String::Copy", string->IsEqual(otherString) && string->Length() == 5, "embedded null byte was not copied.");
+        string->Assign("a");
+        TEST("String::Compare", string->Compare(otherString) < 0 && otherString->Compare(string) > 0, "embedded null byte was treated as the end of the string.");
+
+        otherString->Assign("ab");
+        otherString->Append(otherString);
+        otherString->Append(otherString, 3);
+        TEST("String::Append", otherString->IsEqual("abababa"), "did not append the string to itself.");
+
+        otherString->Clear();
+        for (size_t i = 0; i < 10000; i++)
+            otherString->Append((char)('a' + i % 26));
+        TEST("String::Append", otherString->Length() == 10000 && otherString->GetCharacter(9999) == 'a' + 9999 % 26, "repeated appends produced the wrong string.");
+
+        // Growing out of and back into the inline buffer
+
+        otherString->Assign("0123456789012345678901");
+        TEST("String::Assign", otherString->Length() == 22 && otherString->IsEqual("0123456789012345678901"), "inline string was not assigned.");
+        otherString->Append('X');
+        TEST("String::Append", otherString->Length() == 23 && otherString->EndsWith("01X"), "string did not grow out of the inline buffer.");
+        otherString->Assign("short");
+        TEST("String::Assign", otherString->IsEqual("short"), "string was not shortened after growing.");
+
+        otherString->Assign("hello");
+        otherString->Insert("XY", 2);
+        TEST("String::Insert", otherString->IsEqual("heXYllo") && otherString->Length() == 7, "did not insert into the middle of the string.");
+
+        otherString->Assign("abcdef");
+        otherString->Insert(otherString, 0);
+        otherString->InsertData(otherString->CString() + 4, 5, 4);
+        TEST("String::Insert", otherString->IsEqual("abcdeefabfabcdef"), "did not insert the string into itself.");
+
+        otherString->Reserve(1000);
+        const char *reserved = otherString->CString();
+        TEST("String::Reserve", otherString->Capacity() >= 1000, "did not reserve capacity.");
+        for (size_t i = 0; i < 900; i++)
+            otherString->Append('x');
+        TEST("String::Reserve", otherString->CString() == reserved, "reallocated within reserved capacity.");
+
+        otherString->Assign("shrink");
+        otherString->ShrinkToFit();
+        TEST("String::ShrinkToFit", otherString->Capacity() < 1000 && otherString->IsEqual("shrink"), "did not release spare capacity.");
+
+        // Loading files
+
+        char path[64];
+        WriteTemporaryFile("first\0second", 12, path);
+
+        otherString->AssignFromFile(path);
+        TEST("String::AssignFromFile", otherString->Length() == 12 && otherString->EndsWith("second"), "did not read the whole file.");
+        string->MapFromFile(path);
+        TEST("String::MapFromFile", string->IsEqual(otherString) && string->CString()[12] == '\0', "mapped contents differ from the file.");
+
+        string->ConvertToUppercase();
+        string->Append("!");
+        otherString->AssignFromFile(path);
+        TEST("String::MapFromFile", string->EndsWith("SECOND!") && otherString->EndsWith("second"), "modifying the mapped string changed the file.");
+        unlink(path);
+
+        std::vector<char> page((size_t)sysconf(_SC_PAGESIZE), 'x');
+        WriteTemporaryFile(page.data(), page.size(), path);
+        string->MapFromFile(path);
+        TEST("String::MapFromFile", string->Length() == page.size() && string->CString()[page.size()] == '\0', "page-sized file was not null-terminated.");
+        unlink(path);
+
+        threw = false;
+        try { string->MapFromFile(path); } catch (const std::runtime_error &) { threw = true; }
+        TEST("String::MapFromFile", threw, "mapping a missing file did not throw.");
+
+        threw = false;
+        try { string->AssignFromFile(path); } catch (const std::runtime_error &) { threw = true; }
+        TEST("String::AssignFromFile", threw, "reading a missing file did not throw.");
+
+        // The cached hash follows every modification
+
+        string->Assign("hash me");
+        size_t hash = string->Hash();
+        TEST("String::Hash", hash == String::Hash("hash me", 7) && string->Hash() == hash, "cached hash did not match the contents.");
+
+        string->Append('!');
+        TEST("String::Hash", string->Hash() == String::Hash("hash me!", 8) && string->Hash() != hash, "appending did not invalidate the hash.");
+
+        hash = string->Hash();
+        string->GetCharacter(0) = 'c';
+        string->ConvertToUppercase();
+        TEST("String::Hash", string->Hash() == String::Hash("CASH ME!", 8), "modifying in place did not invalidate the hash.");
+
+        otherString->Assign("CASH ME?");
+        otherString->Hash();
+        TEST("String::IsEqual", !string->IsEqual(otherString) && otherString->IsEqual("CASH ME?"), "strings with different hashes compared equal.");
+
+        // Searching and replacement
+
+        string->Assign("one two one two one");
+        TEST("String::Find", string->Find("two") == 4 && string->Find("two", 5) == 12 && string->Find("three") == String::NotFound, "reported the wrong match.");
+        TEST("String::Find", string->Find("") == 0 && string->Find("one", string->Length()) == String::NotFound, "mishandled an empty needle or the end of the string.");
+        TEST("String::FindLast", string->FindLast("one") == 16 && string->FindLast("three") == String::NotFound, "reported the wrong match.");
+        TEST("String::Contains", string->Contains("two one") && !string->Contains("one one"), "reported the wrong result.");
+        TEST("String::Count", string->Count("one") == 3 && string->Count("o") == 5, "reported the wrong count.");
+
+        threw = false;
+        try { string->Find("one", string->Length() + 1); } catch (const std::exception &) { threw = true; }
+        TEST("String::Find", threw, "start index past the end did not throw.");
+
+        otherString->Assign("aaaa");
+        TEST("String::Count", otherString->Count("aa") == 2, "counted overlapping matches.");
+
+        TEST("String::Replace", string->Replace("one", "1") == 3 && string->IsEqual("1 two 1 two 1"), "shrinking replacement failed.");
+        TEST("String::Replace", string->Replace("1", "three") == 3 && string->IsEqual("three two three two three"), "growing replacement failed.");
+        TEST("String::Replace", string->Replace(" two", "") == 2 && string->IsEqual("three three three"), "removal failed.");
+        TEST("String::Replace", string->Replace("four", "five") == 0 && string->IsEqual("three three three"), "replaced a missing target.");
+
+        otherString->Assign("three");
+        TEST("String::Replace", string->Replace(otherString, string) == 3 && string->Length() == 17 * 3 + 2 && string->StartsWith("three three three three"), "replacement aliasing the string failed.");
+
+        // Case-insensitive comparison
+
+        string->Assign("Hello, World");
+        TEST("String::IsEqualIgnoringCase", string->IsEqualIgnoringCase("hELLO, wORLD") && !string->IsEqualIgnoringCase("Hello, World!"), "reported the wrong result.");
+        TEST("String::CompareIgnoringCase", string->CompareIgnoringCase("HELLO, WORLD") == 0 && string->CompareIgnoringCase("hello, x") < 0 && string->CompareIgnoringCase("HELLO") > 0, "reported the wrong order.");
+        TEST("String::CompareIgnoringCase", string->CompareIgnoringCase("hello, world!") < 0 && string->CompareIgnoringCase("Hello_") < 0, "did not compare as lowercase.");
+
         string->Release();
         otherString->Release();
 
         END_TEST;
     }
 
+    void TestStringTable()
+    {
+        BEGIN_TEST("StringTable");
+
+        StringTable table;
+        String *name = table.Intern("name");
+        String *same = table.Intern(std::string_view("name (with trailing data)", 4));
+        String *other = table.Intern("other");
+        TEST("StringTable::Intern", same == name && other != name && name->GetReferenceCount() == 2, "did not return one retained string per content.");
+        TEST("StringTable::Intern", name->IsEqual("name") && name->IsInterned() && name->GetReferenceCounting() == ReferenceCounting::Atomic, "interned string was not atomic and immutable.");
+        same->Release();
+
+        bool threw = false;
+        try { name->Append("s"); }
+        catch (const std::exception &) { threw = true; }
+        TEST("String::IsInterned", threw && name->IsEqual("name"), "interned string was modified.");
+
+        String *copy = new String("name");
+        same = table.Intern(copy);
+        TEST("StringTable::Intern", same == name && !copy->IsInterned(), "interning a string did not find its canonical string.");
+        same->Release();
+        copy->Release();
+
+        // Interned strings remove their entries when they are destroyed, so the table never keeps dead strings
+
+        other->Release();
+        TEST("StringTable::Count", table.Count() == 1, "destroyed string kept its entry.");
+
+        name->Release();
+        name = table.Intern("name");
+        TEST("StringTable::Intern", table.Count() == 1 && name->GetReferenceCount() == 1, "string was not interned again after it was destroyed.");
+
+        // Dictionaries share interned keys between each other, and find them by pointer; keys given by contents are copied, not interned
+
+        size_t sharedCount = StringTable::Shared().Count();
+        Dictionary *first = new Dictionary();
+        Dictionary *second = new Dictionary();
+        Object *obj = new Object();
+        first->SetObject(name, obj);
+        second->SetObject(name, obj);
+        first->SetObject(std::string_view("field"), obj);
+
+        Array *firstKeys = new Array();
+        first->GetAllKeys(firstKeys);
+
+        TEST("Dictionary::GetAllKeys", (firstKeys->ObjectAtIndex(0) == name || firstKeys->ObjectAtIndex(1) == name) && name->GetReferenceCount() == 4, "interned keys were copied.");
+        TEST("Dictionary::GetObject", first->GetObject(name) == obj && second->Contains(name) && StringTable::Shared().Count() == sharedCount, "lookup by interned key failed, or a key was interned.");
+
+        firstKeys->Release();
+        first->Release();
+        second->Release();
+        obj->Release();
+
+        // Destroying a table leaves the strings it interned alive and immutable
+
+        StringTable *scoped = new StringTable();
+        String *survivor = scoped->Intern("survivor");
+        delete scoped;
+        TEST("StringTable::~StringTable", survivor->IsEqual("survivor") && survivor->IsInterned(), "string did not outlive its table.");
+        survivor->Release();
+        name->Release();
+
+        END_TEST;
+    }
+
+    void TestStringKernels()
+    {
+        BEGIN_TEST("StringKernels");
+
+        using namespace StringKernels;
+        InstructionSet original = GetInstructionSet();
+        TEST("StringKernels::IsSupported", IsSupported(InstructionSet::Scalar) && IsSupported(original), "selected instruction set is not supported.");
+
+        // Every supported instruction set must agree with the scalar kernels on random inputs of every length around the vector widths
+
+        srand(1);
+        std::vector<char> data(300), first(300), second(300);
+        bool findAgrees = true, caseAgrees = true, compareAgrees = true;
+
+        for (size_t length = 0; length < data.size(); length++)
+        {
+            for (size_t i = 0; i < length; i++)
+                data[i] = "aAbB!\xff"[rand() % 6];
+
+            size_t needleLength = length == 0 ? 0 : rand() % (length < 5 ? length : 5);
+            const char *needle = data.data() + (length == 0 ? 0 : rand() % (length - needleLength + 1));
+            const char *missing = "zzz";
+
+            for (size_t i = 0; i < length; i++)
+            {
+                first[i] = data[i];
+                second[i] = rand() % 4 == 0 ? (char)(data[i] ^ 0x20) : data[i];
+            }
+
+            SetInstructionSet(InstructionSet::Scalar);
+            const char *expectedFind = Find(data.data(), length, needle, needleLength);
+            const char *expectedFindLast = FindLast(data.data(), length, needle, needleLength);
+            int expectedCompare = CompareIgnoringCase(first.data(), second.data(), length);
+
+            std::vector<char> expectedUpper(data.begin(), data.begin() + length), expectedLower(expectedUpper);
+            ConvertToUppercase(expectedUpper.data(), length);
+            ConvertToLowercase(expectedLower.data(), length);
+
+            for (InstructionSet instructionSet : { InstructionSet::SSE2, InstructionSet::AVX2 })
+            {
+                if (!IsSupported(instructionSet))
+                    continue;
+
+                SetInstructionSet(instructionSet);
+                findAgrees &= Find(data.data(), length, needle, needleLength) == expectedFind && FindLast(data.data(), length, needle, needleLength) == expectedFindLast;
+                findAgrees &= Find(data.data(), length, missing, 3) == nullptr && FindLast(data.data(), length, missing, 3) == nullptr;
+                compareAgrees &= CompareIgnoringCase(first.data(), second.data(), length) == expectedCompare;
+
+                std::vector<char> upper(data.begin(), data.begin() + length), lower(upper);
+                ConvertToUppercase(upper.data(), length);
+                ConvertToLowercase(lower.data(), length);
+                caseAgrees &= upper == expectedUpper && lower == expectedLower;
+            }
+        }
+
+        SetInstructionSet(original);
+        TEST("StringKernels::Find", findAgrees, "vector search disagreed with scalar search.");
+        TEST("StringKernels::ConvertToUppercase", caseAgrees, "vector case conversion disagreed with scalar case conversion.");
+        TEST("StringKernels::CompareIgnoringCase", compareAgrees, "vector comparison disagreed with scalar comparison.");
+
+        // Matches at the last possible position of a buffer must not read past it
+
+        std::vector<char> tail(64, 'a');
+        tail[63] = 'b';
+        TEST("StringKernels::Find", Find(tail.data(), tail.size(), "ab", 2) == tail.data() + 62 && FindLast(tail.data(), tail.size(), "b", 1) == tail.data() + 63, "missed a match at the end.");
+
+        bool threw = false;
+        for (InstructionSet instructionSet : { InstructionSet::SSE2, InstructionSet::AVX2 })
+        {
+            if (IsSupported(instructionSet))
+                continue;
+
+            try { SetInstructionSet(instructionSet); } catch (const std::exception &) { threw = true; }
+        }
+        TEST("StringKernels::SetInstructionSet", threw || (IsSupported(InstructionSet::SSE2) && IsSupported(InstructionSet::AVX2)), "selecting an unsupported instruction set did not throw.");
+        TEST("StringKernels::GetInstructionSet", GetInstructionSet() == original, "did not restore the instruction set.");
+
+        END_TEST;
+    }
+
+    void TestStringView()
+    {
+        BEGIN_TEST("StringView");
+
+        String *string = new String("key=value;other=thing");
+        StringView view(string, 4, 5);
+        TEST("StringView::StringView", view.IsEqual("value") && view.Length() == 5 && view.Parent() == string, "view did not refer to the range.");
+        TEST("StringView::StringView", string->GetReferenceCount() == 2 && view.Data() == string->CString() + 4, "view copied its parent or did not retain it.");
+
+        StringView copy = view;
+        StringView slice = view.Slice(1, 3);
+        TEST("StringView::Slice", slice.IsEqual("alu") && slice.StartIndex() == 5 && string->GetReferenceCount() == 4, "slice did not share the parent.");
+
+        StringView moved = std::move(copy);
+        TEST("StringView::StringView", moved.IsEqual(view) && copy.Empty() && copy.Parent() == nullptr && string->GetReferenceCount() == 4, "moving retained the parent.");
+
+        bool threw = false;
+        try { view.Slice(2, 4); } catch (const std::exception &) { threw = true; }
+        TEST("StringView::Slice", threw, "slice past the end of the view did not throw.");
+
+        // Comparison and searching follow String, relative to the view
+
+        StringView other(string, 16, 5);
+        TEST("StringView::Compare", view.Compare(other) > 0 && other.Compare("thing") == 0 && view.Compare("valued") < 0, "reported the wrong order.");
+        TEST("StringView::Hash", view.Hash() == String::Hash("value", 5) && StringView(string).Hash() == string->Hash(), "hash did not match the contents.");
+        TEST("StringView::Find", view.Find('l') == 2 && view.Find("ue") == 3 && view.Find(';') == String::NotFound, "searched outside the view.");
+
+        // Dictionary lookups take views as string views, without materializing them
+
+        Dictionary *dictionary = new Dictionary();
+        Object *obj = new Object();
+        dictionary->SetObject("value", obj);
+        TEST("StringView::operator std::string_view", dictionary->GetObject(view) == obj && !dictionary->Contains(other), "lookup by view failed.");
+
+        String *materialized = view.ToString();
+        TEST("StringView::ToString", materialized->IsEqual("value") && materialized != string && materialized->GetReferenceCount() == 1, "did not materialize an owning copy.");
+        materialized->Release();
+
+        string->Assign("short");
+        threw = false;
+        try { view.Data(); } catch (const std::exception &) { threw = true; }
+        TEST("StringView::Data", threw, "view of a shortened parent did not throw.");
+
+        dictionary->Release();
+        obj->Release();
+        view = StringView();
+        slice = StringView();
+        moved = StringView();
+        other = StringView();
+        TEST("StringView::~StringView", string->GetReferenceCount() == 1, "views did not release the parent.");
+        string->Release();
+
+        END_TEST;
+    }
+
+    void TestStringBuilder()
+    {
+        BEGIN_TEST("StringBuilder");
+
+        StringBuilder *builder = new StringBuilder();
+        String *string = builder->ToString();
+        TEST("StringBuilder::ToString", builder->Empty() && builder->ChunkCount() == 0 && string->Empty(), "new builder was not empty.");
+        string->Release();
+
+        String *part = new String("two");
+        builder->Append('1');
+        builder->Append(part);
+        builder->Append(std::string_view("three", 3));
+        builder->AppendData("\0four", 5);
+        builder->AppendFormat("%d%s", 5, "six");
+        string = builder->ToString();
+        TEST("StringBuilder::Append", builder->Length() == 16 && string->Length() == 16 && memcmp(string->CString(), "1twothr\0four5six", 16) == 0, "did not append every fragment.");
+        string->Release();
+        part->Release();
+
+        // Appends never move earlier chunks, and the chunks grow so that their count stays logarithmic
+
+        std::vector<iovec> chunks;
+        builder->GetChunks(&chunks);
+        void *first = chunks[0].iov_base;
+
+        for (size_t i = 0; i < 100000; i++)
+            builder->Append("0123456789");
+
+        builder->GetChunks(&chunks);
+        size_t total = 0;
+        for (const iovec &chunk : chunks)
+            total += chunk.iov_len;
+        TEST("StringBuilder::GetChunks", chunks[0].iov_base == first && total == builder->Length() && builder->Length() == 16 + 1000000, "chunks were moved or did not cover the contents.");
+        TEST("StringBuilder::ChunkCount", builder->ChunkCount() < 16, "allocated too many chunks.");
+
+#ifdef SCOOP_MEMORY_COUNT_ALLOCATIONS
+        size_t before = allocationCount;
+#endif
+        builder->AppendFormat("%zu", (size_t)42);
+#ifdef SCOOP_MEMORY_COUNT_ALLOCATIONS
+        TEST("StringBuilder::AppendFormat", allocationCount == before, "formatting into spare chunk capacity allocated.");
+#endif
+
+        std::vector<char> large(100000, 'x');
+        large.push_back('\0');
+        builder->AppendFormat("[%s]", large.data());
+        string = builder->ToString();
+        TEST("StringBuilder::AppendFormat", string->Length() == builder->Length() && string->EndsWith("xxxxx]") && string->CString()[16 + 1000000 + 2] == '[', "formatting past the last chunk failed.");
+
+        // WriteTo gathers the chunks with writev
+
+        char path[64];
+        WriteTemporaryFile("", 0, path);
+        int file = open(path, O_WRONLY | O_TRUNC);
+        builder->WriteTo(file);
+        close(file);
+
+        String *written = new String();
+        written->AssignFromFile(path);
+        TEST("StringBuilder::WriteTo", written->IsEqual(string), "written contents differ from the builder.");
+        unlink(path);
+        written->Release();
+        string->Release();
+
+        bool threw = false;
+        try { builder->WriteTo(-1); } catch (const std::exception &) { threw = true; }
+        TEST("StringBuilder::WriteTo", threw, "writing to an invalid file descriptor did not throw.");
+
+        threw = false;
+        try { builder->Append((const char *)nullptr); } catch (const std::exception &) { threw = true; }
+        TEST("StringBuilder::Append", threw, "appending nullptr did not throw.");
+
+        builder->Clear();
+        TEST("StringBuilder::Clear", builder->Empty() && builder->ChunkCount() == 0, "did not release the chunks.");
+        builder->Release();
+
+        END_TEST;
+    }
+
     void TestProperty()
     {
         class TestClass
@@ -159,6 +683,257 @@ namespace Scoop::Memory::TestScoopMemory
 
         propObj->Release();
 
+        // Copying and moving
+
+        obj = new Object();
+        Property<Object> original;
+        original.Adopt(obj);
+        TEST("Property::Adopt", original.Get() == obj && obj->GetReferenceCount() == 1, "adopted object was retained.");
+
+        original = obj;
+        TEST("Property::Assign", obj->GetReferenceCount() == 1, "reassigning the held object changed its reference count.");
+
+        {
+            Property<Object> copy = original;
+            TEST("Property::Property", copy.Get() == obj && obj->GetReferenceCount() == 2, "copy did not retain object.");
+
+            Property<Object> moved = std::move(copy);
+            TEST("Property::Property", moved.Get() == obj && copy.Get() == nullptr && obj->GetReferenceCount() == 2, "move changed the reference count.");
+
+            original = std::move(moved);
+            TEST("Property::operator=", original.Get() == obj && moved.Get() == nullptr && obj->GetReferenceCount() == 1, "move assignment did not release the previous reference.");
+        }
+
+        std::vector<Property<Object>> properties;
+        for (size_t i = 0; i < 100; i++)
+            properties.push_back(original);
+
+        TEST("Property::Property", obj->GetReferenceCount() == 101, "properties in a vector were not retained exactly once.");
+        properties.clear();
+        TEST("Property::~Property", obj->GetReferenceCount() == 1, "properties in a vector were not released.");
+
+        // Assigning an object that only the previous object keeps alive
+
+        Array *outer = new Array();
+        Array *inner = new Array();
+        outer->AddObject(inner);
+        inner->Release();
+
+        Property<Array> holder;
+        holder.Adopt(outer);
+        holder = inner;
+        TEST("Property::Assign", holder.Get() == inner && inner->GetReferenceCount() == 1, "new object was freed by releasing the old one.");
+
+        END_TEST;
+    }
+
+    void TestWeakProperty()
+    {
+        class Node : public Object
+        {
+            private:
+                bool &didDelete;
+            public:
+                Property<Node> child;
+                WeakProperty<Node> parent;
+                Node(bool &didDelete) : didDelete(didDelete) { }
+                ~Node() { this->didDelete = true; }
+        };
+
+        BEGIN_TEST("WeakProperty");
+
+        WeakProperty<Object> empty;
+        TEST("WeakProperty::Lock", empty.Lock() == nullptr && empty.Expired(), "empty reference was not expired.");
+
+        Object *obj = new Object();
+        WeakProperty<Object> weak = obj;
+        TEST("WeakProperty::WeakProperty", obj->GetReferenceCount() == 1, "weak reference retained the object.");
+
+        Object *locked = weak.Lock();
+        TEST("WeakProperty::Lock", locked == obj && obj->GetReferenceCount() == 2, "did not return a retained object.");
+        locked->Release();
+
+        WeakProperty<Object> copy = weak;
+        TEST("WeakProperty::WeakProperty", copy.Lock() == obj, "copy does not refer to the object.");
+        obj->Release();
+
+        obj->Release();
+        TEST("WeakProperty::Lock", weak.Lock() == nullptr && copy.Lock() == nullptr, "reference did not zero upon deallocation.");
+        TEST("WeakProperty::Expired", weak.Expired() && copy.Expired(), "reference did not expire.");
+
+        // A parent link does not keep the parent alive
+
+        bool parentDeleted = false, childDeleted = false;
+        Node *parent = new Node(parentDeleted);
+        Node *child = new Node(childDeleted);
+        parent->child = child;
+        child->parent = parent;
+        child->Release();
+
+        Node *parentLocked = parent->child->parent.Lock();
+        TEST("WeakProperty::Lock", parentLocked == parent, "child did not reach its parent.");
+        parentLocked->Release();
+
+        parent->Release();
+        TEST("WeakProperty::~WeakProperty", parentDeleted && childDeleted, "parent link created a retain cycle.");
+
+        // A child destroyed along with its parent cannot reach the parent any more, whichever counting mode it uses
+
+        class BackLinkedNode : public Object
+        {
+            public:
+                Property<BackLinkedNode> child;
+                WeakProperty<BackLinkedNode> parent;
+                bool *parentReachable = nullptr;
+                BackLinkedNode(ReferenceCounting mode) : Object(mode) { }
+
+                ~BackLinkedNode()
+                {
+                    if (this->parentReachable == nullptr)
+                        return;
+
+                    BackLinkedNode *locked = this->parent.Lock();
+                    *this->parentReachable = locked != nullptr || !this->parent.Expired();
+                    if (locked != nullptr)
+                        locked->Release();
+                }
+        };
+
+        bool reachable[2] = { true, true };
+        for (ReferenceCounting mode : { ReferenceCounting::NonAtomic, ReferenceCounting::Atomic })
+        {
+            BackLinkedNode *backParent = new BackLinkedNode(mode);
+            BackLinkedNode *backChild = new BackLinkedNode(mode);
+            backChild->parent = backParent;
+            backChild->parentReachable = &reachable[mode == ReferenceCounting::Atomic];
+            backParent->child = backChild;
+            backChild->Release();
+            backParent->Release();
+        }
+        TEST("WeakProperty::Lock", !reachable[0] && !reachable[1], "child locked its parent from its destructor.");
+
+        // Locking races with the final release
+
+        ThreadSafe<Object> *shared = new ThreadSafe<Object>();
+        WeakProperty<Object> sharedWeak = shared;
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&sharedWeak]()
+            {
+                for (size_t i = 0; i < 10000; i++)
+                {
+                    if (Object *strong = sharedWeak.Lock())
+                        strong->Release();
+                }
+            });
+        }
+
+        shared->Release();
+        for (std::thread &thread : threads)
+            thread.join();
+
+        TEST("WeakProperty::Lock", sharedWeak.Lock() == nullptr, "released object was resurrected.");
+
+        {
+            Arena arena;
+            String *string = arena.New<String>("arena");
+            weak = string;
+        }
+
+        TEST("WeakProperty::Expired", weak.Expired(), "arena teardown did not zero the reference.");
+
+        END_TEST;
+    }
+
+    void TestAtomicProperty()
+    {
+        class Snapshot : public Object
+        {
+            private:
+                std::atomic<size_t> &destroyed;
+            public:
+                size_t version;
+                Snapshot(std::atomic<size_t> &destroyed, size_t version) : Object(ReferenceCounting::Atomic), destroyed(destroyed), version(version) { }
+                ~Snapshot() { this->destroyed++; }
+        };
+
+        BEGIN_TEST("AtomicProperty");
+
+        AtomicProperty<Object> prop;
+        TEST("AtomicProperty::Load", prop.Load() == nullptr, "empty property did not load nullptr.");
+
+        bool threw = false;
+        Object *nonAtomic = new Object(ReferenceCounting::NonAtomic);
+        try { prop.Store(nonAtomic); } catch (const std::runtime_error &) { threw = true; }
+        TEST("AtomicProperty::Store", threw && nonAtomic->GetReferenceCount() == 1, "storing a non-atomic object did not throw.");
+        nonAtomic->Release();
+
+        ThreadSafe<Object> *first = new ThreadSafe<Object>();
+        prop = first;
+        TEST("AtomicProperty::Store", first->GetReferenceCount() == 2, "stored object was not retained.");
+
+        Object *loaded = prop.Load();
+        TEST("AtomicProperty::Load", loaded == first && first->GetReferenceCount() == 3, "loaded object was not retained.");
+        loaded->Release();
+
+        ThreadSafe<Object> *second = new ThreadSafe<Object>();
+        prop = second;
+        HazardPointers::Reclaim();
+        TEST("AtomicProperty::Store", first->GetReferenceCount() == 1 && HazardPointers::PendingCount() == 0, "replaced object was not released.");
+
+        first->Release();
+        second->Release();
+
+        // Readers race a writer that keeps replacing the snapshot
+
+        std::atomic<size_t> destroyed { 0 };
+        std::atomic<bool> stop { false };
+        std::atomic<bool> ordered { true };
+
+        {
+            AtomicProperty<Snapshot> current;
+            Snapshot *initial = new Snapshot(destroyed, 0);
+            current = initial;
+            initial->Release();
+
+            std::vector<std::thread> readers;
+            for (size_t t = 0; t < 4; t++)
+            {
+                readers.emplace_back([&current, &stop, &ordered]()
+                {
+                    size_t last = 0;
+                    while (!stop.load())
+                    {
+                        Snapshot *snapshot = current.Load();
+                        if (snapshot->version < last)
+                            ordered = false;
+
+                        last = snapshot->version;
+                        snapshot->Release();
+                    }
+                });
+            }
+
+            for (size_t version = 1; version <= 2000; version++)
+            {
+                Snapshot *snapshot = new Snapshot(destroyed, version);
+                current = snapshot;
+                snapshot->Release();
+            }
+
+            stop = true;
+            for (std::thread &reader : readers)
+                reader.join();
+
+            HazardPointers::Reclaim();
+            TEST("AtomicProperty::Load", ordered.load(), "a reader observed an older snapshot after a newer one.");
+            TEST("HazardPointers::Reclaim", destroyed.load() == 2000, "replaced snapshots were not all released.");
+        }
+
+        TEST("AtomicProperty::~AtomicProperty", destroyed.load() == 2001, "held snapshot was not released.");
+
         END_TEST;
     }
 
@@ -221,6 +996,95 @@ namespace Scoop::Memory::TestScoopMemory
         array->RemoveObjects(otherArray);
         TEST("Array::RemoveObjects", !array->Contains(obj) && !array->Contains(otherArray) && array->Contains(thirdObject), "did not remove specified objects.");
 
+        // Identity index
+
+        array->SetIndexed(true);
+        TEST("Array::SetIndexed", array->IsIndexed() && array->Contains(thirdObject) && !array->Contains(obj), "index does not match contents.");
+
+        array->AddObject(obj);
+        array->AddObject(obj);
+        TEST("Array::AddObject", array->Count() == 2 && obj->GetReferenceCount() == 3, "indexed array added a duplicate.");
+
+        size_t index = 0;
+        TEST("Array::Contains", array->Contains(obj, &index) && index == 1, "indexed array reported the wrong index.");
+
+        array->RemoveObject(obj);
+        array->RemoveObject(otherObj);
+        TEST("Array::RemoveObject", !array->Contains(obj) && array->Count() == 1 && obj->GetReferenceCount() == 2, "indexed array did not remove object.");
+
+        array->RemoveObjectAtIndex(0);
+        array->Copy(otherArray);
+        TEST("Array::Copy", array->Contains(obj) && array->Contains(otherObj) && !array->Contains(thirdObject), "index was not rebuilt by copy.");
+
+        array->Clear();
+        TEST("Array::Clear", !array->Contains(obj) && array->Count() == 0, "index was not cleared.");
+
+        array->AddObject(obj);
+        array->AddObject(otherObj);
+        array->AddObject(thirdObject);
+        array->RemoveObject(obj);
+
+        size_t thirdIndex = 0, otherIndex = 0;
+        bool positions = array->ObjectAtIndex(0) == thirdObject && array->Contains(thirdObject, &thirdIndex) && thirdIndex == 0;
+        array->RemoveObjectAtIndex(0);
+        positions = positions && array->Contains(otherObj, &otherIndex) && otherIndex == 0 && array->Count() == 1;
+        TEST("Array::RemoveObject", positions, "indexed removal did not move the last object into the gap or positions went stale.");
+
+        array->Clear();
+        array->AddObject(obj);
+        array->SetIndexed(false);
+        TEST("Array::SetIndexed", !array->IsIndexed() && array->Contains(obj), "disabling the index lost objects.");
+
+        // Bulk and unordered removal
+
+        array->Clear();
+        array->AddObject(obj);
+        array->AddObject(otherObj);
+        array->AddObject(thirdObject);
+
+        array->RemoveObjectAtIndexUnordered(0);
+        TEST("Array::RemoveObjectAtIndexUnordered", array->Count() == 2 && array->ObjectAtIndex(0) == thirdObject && obj->GetReferenceCount() == 2, "did not move the last object into the gap.");
+
+        array->RemoveObjectsIf([otherObj](Object *object) { return object == otherObj; });
+        TEST("Array::RemoveObjectsIf", array->Count() == 1 && array->ObjectAtIndex(0) == thirdObject && otherObj->GetReferenceCount() == 2, "did not remove matching objects.");
+
+        Array *many = new Array();
+        for (size_t i = 0; i < 100; i++)
+        {
+            Object *object = new Object();
+            array->AddObject(object);
+            if (i % 3 == 0)
+                many->AddObject(object);
+            object->Release();
+        }
+
+        Object *survivor = array->ObjectAtIndex(2);
+        array->RemoveObjects(many);
+        TEST("Array::RemoveObjects", array->Count() == 67 && array->ObjectAtIndex(0) == thirdObject && array->ObjectAtIndex(1) == survivor, "bulk removal did not preserve order.");
+        many->Release();
+
+        // Copies and snapshots share storage until one of them is modified
+
+        unsigned survivorReferences = survivor->GetReferenceCount();
+        Array *copy = new Array();
+        copy->Copy(array);
+        TEST("Array::Copy", copy->Count() == 67 && survivor->GetReferenceCount() == survivorReferences, "copy did not share storage.");
+
+        copy->RemoveObjectAtIndex(0);
+        TEST("Array::Copy", copy->Count() == 66 && array->Count() == 67 && survivor->GetReferenceCount() == survivorReferences + 1, "modifying a copy did not copy its storage.");
+        copy->Release();
+
+        Array *snapshot = array->Snapshot();
+        bool snapshotThrew = false;
+        try { snapshot->AddObject(obj); }
+        catch (const std::exception &) { snapshotThrew = true; }
+        TEST("Array::Snapshot", snapshot->IsFrozen() && snapshotThrew && snapshot->Count() == 67, "snapshot was not frozen.");
+
+        array->RemoveObject(survivor);
+        TEST("Array::Snapshot", array->Count() == 66 && snapshot->Count() == 67 && snapshot->ObjectAtIndex(1) == survivor, "snapshot observed a later modification.");
+        snapshot->Release();
+
+        array->Release();
         otherArray->Release();
 
         obj->Release();
@@ -275,6 +1139,88 @@ namespace Scoop::Memory::TestScoopMemory
         dict->Remove("a");
         TEST("Dictionary::Remove", !dict->Contains("a"), "did not remove key-value pair.");
         TEST("Dictionary::Remove", str->GetReferenceCount() == 1, "did not release object.");
+        TEST("Dictionary::Count", dict->Count() == 1, "incorrect entry count.");
+
+        dict->SetObject("b", str);
+        TEST("Dictionary::SetObject", dict->Count() == 1 && dict->GetObject("b") == str, "did not replace existing value.");
+        TEST("Dictionary::SetObject", obj->GetReferenceCount() == 1, "did not release replaced value.");
+
+        String *mutableKey = new String("mutable");
+        dict->SetObject(mutableKey, obj);
+        mutableKey->Assign("changed");
+        TEST("Dictionary::SetObject", dict->Contains("mutable") && !dict->Contains("changed") && mutableKey->GetReferenceCount() == 1, "shared a key that is not interned.");
+        dict->Remove("mutable");
+        mutableKey->Release();
+
+        // Many keys, forcing the table to grow and removals to shift colliding entries
+
+        String *key = new String();
+        for (size_t i = 0; i < 1000; i++)
+        {
+            key->AssignFormat("key%zu", i);
+            dict->SetObject(key->CString(), obj);
+        }
+        TEST("Dictionary::Count", dict->Count() == 1001, "incorrect entry count after growing.");
+
+        for (size_t i = 0; i < 1000; i += 2)
+        {
+            key->AssignFormat("key%zu", i);
+            dict->Remove(key->CString());
+        }
+
+        bool found = true;
+        for (size_t i = 0; i < 1000; i++)
+        {
+            key->AssignFormat("key%zu", i);
+            if (dict->Contains(key) != (i % 2 == 1))
+                found = false;
+        }
+        TEST("Dictionary::Remove", found && dict->Count() == 501, "entries were lost or not removed.");
+        TEST("Dictionary::Remove", obj->GetReferenceCount() == 501, "did not balance value references.");
+
+        // Lookups must not allocate, whichever key type is used
+
+        key->Assign("key1");
+        std::string_view view("key1 (with trailing data)", 4);
+#ifdef SCOOP_MEMORY_COUNT_ALLOCATIONS
+        size_t allocations = allocationCount;
+#endif
+
+        bool lookups = dict->Contains("key1") && dict->Contains(view) && dict->Contains(key);
+        lookups = lookups && dict->GetObject("key1") == obj && dict->GetObject(view) == obj && dict->GetObject(key) == obj;
+        lookups = lookups && dict->GetObjectIfPresent("key3") == obj && dict->GetObjectIfPresent(std::string_view("key3x", 4)) == obj;
+        lookups = lookups && dict->GetObjectIfPresent("missing") == nullptr;
+        dict->SetObject(view, obj);
+        dict->Remove(std::string_view("key5", 4));
+        dict->Remove("key7");
+
+        TEST("Dictionary::GetObject", lookups, "heterogeneous lookup returned the wrong value.");
+#ifdef SCOOP_MEMORY_COUNT_ALLOCATIONS
+        TEST("Dictionary::GetObject", allocationCount == allocations, "lookup allocated memory.");
+#endif
+        TEST("Dictionary::Remove", !dict->Contains("key5") && !dict->Contains("key7"), "did not remove by key view.");
+
+        // Copies and snapshots share storage until one of them is modified
+
+        Dictionary *copy = new Dictionary();
+        copy->Copy(dict);
+        TEST("Dictionary::Copy", copy->Count() == dict->Count() && obj->GetReferenceCount() == 499, "copy did not share storage.");
+
+        copy->Remove("key1");
+        TEST("Dictionary::Copy", copy->Count() == 498 && dict->Contains("key1") && obj->GetReferenceCount() == 996, "modifying a copy did not copy its storage.");
+        copy->Release();
+
+        Dictionary *snapshot = dict->Snapshot();
+        bool snapshotThrew = false;
+        try { snapshot->SetObject("key1", str); }
+        catch (const std::exception &) { snapshotThrew = true; }
+        TEST("Dictionary::Snapshot", snapshot->IsFrozen() && snapshotThrew && snapshot->GetObject("key1") == obj, "snapshot was not frozen.");
+
+        dict->Clear();
+        TEST("Dictionary::Snapshot", dict->Count() == 0 && snapshot->Count() == 499 && obj->GetReferenceCount() == 499, "snapshot observed a later modification.");
+        snapshot->Release();
+
+        key->Release();
 
         dict->Release();
         str->Release();
@@ -283,12 +1229,577 @@ namespace Scoop::Memory::TestScoopMemory
         END_TEST;
     }
 
+    void TestPersistentDictionary()
+    {
+        BEGIN_TEST("PersistentDictionary");
+
+        PersistentDictionary *empty = new PersistentDictionary();
+        Object *obj = new Object();
+        Object *otherObj = new Object();
+
+        PersistentDictionary *first = empty->With("first", obj);
+        TEST("PersistentDictionary::With", first->Count() == 1 && first->GetObject("first") == obj && obj->GetReferenceCount() == 2, "did not add entry.");
+        TEST("PersistentDictionary::With", empty->Count() == 0 && !empty->Contains("first"), "modified the original version.");
+
+        // Many versions derived one from another
+
+        std::vector<PersistentDictionary *> versions = { first };
+        String *key = new String();
+        for (size_t i = 0; i < 1000; i++)
+        {
+            key->AssignFormat("key%zu", i);
+            versions.push_back(versions.back()->With(key->CString(), obj));
+        }
+
+        PersistentDictionary *latest = versions.back();
+        bool found = true;
+        for (size_t i = 0; i < 1000; i++)
+        {
+            key->AssignFormat("key%zu", i);
+            if (latest->GetObjectIfPresent(key) != obj || versions[i + 1]->Contains(key) != true || versions[i]->Contains(key))
+                found = false;
+        }
+        TEST("PersistentDictionary::With", found && latest->Count() == 1001, "versions did not hold exactly their own entries.");
+
+        PersistentDictionary *replaced = latest->With("key1", otherObj);
+        TEST("PersistentDictionary::With", replaced->Count() == 1001 && replaced->GetObject("key1") == otherObj && latest->GetObject("key1") == obj, "replacing a value was not isolated to the new version.");
+
+        PersistentDictionary *removed = replaced;
+        for (size_t i = 0; i < 1000; i += 2)
+        {
+            key->AssignFormat("key%zu", i);
+            PersistentDictionary *next = removed->Without(key);
+            if (removed != replaced)
+                removed->Release();
+            removed = next;
+        }
+
+        found = true;
+        for (size_t i = 0; i < 1000; i++)
+        {
+            key->AssignFormat("key%zu", i);
+            if (removed->Contains(key) != (i % 2 == 1) || !replaced->Contains(key))
+                found = false;
+        }
+        TEST("PersistentDictionary::Without", found && removed->Count() == 501 && replaced->Count() == 1001, "entries were lost or not removed.");
+
+        PersistentDictionary *unchanged = removed->Without("missing");
+        TEST("PersistentDictionary::Without", unchanged->Count() == 501, "removing a missing key changed the count.");
+        unchanged->Release();
+
+        bool threw = false;
+        try { removed->With("key", nullptr); }
+        catch (const std::exception &) { threw = true; }
+        TEST("PersistentDictionary::With", threw, "did not throw on a null value.");
+
+        String *mutableKey = new String("mutable");
+        PersistentDictionary *withKey = removed->With(mutableKey, obj);
+        mutableKey->Assign("changed");
+        TEST("PersistentDictionary::With", withKey->Contains("mutable") && !withKey->Contains("changed") && mutableKey->GetReferenceCount() == 1, "shared a key that is not interned.");
+        withKey->Release();
+        mutableKey->Release();
+
+        // Conversion to and from Dictionary
+
+        Dictionary *dict = new Dictionary();
+        dict->SetObject("first", otherObj);
+        dict->SetObject("extra", otherObj);
+
+        PersistentDictionary *merged = first->WithEntries(dict);
+        TEST("PersistentDictionary::WithEntries", merged->Count() == 2 && merged->GetObject("first") == otherObj && first->GetObject("first") == obj, "did not merge dictionary entries.");
+
+        PersistentDictionary *trimmed = merged->Without("extra");
+        trimmed->CopyTo(dict);
+        TEST("PersistentDictionary::CopyTo", dict->Count() == 1 && dict->GetObject("first") == otherObj, "did not replace dictionary contents.");
+        trimmed->Release();
+        merged->Release();
+        dict->Release();
+
+        for (PersistentDictionary *version : versions)
+            version->Release();
+
+        removed->Release();
+        replaced->Release();
+        empty->Release();
+        key->Release();
+        TEST("PersistentDictionary::~PersistentDictionary", obj->GetReferenceCount() == 1 && otherObj->GetReferenceCount() == 1, "did not balance value references.");
+
+        obj->Release();
+        otherObj->Release();
+
+        END_TEST;
+    }
+
+    void TestAutoreleasePool()
+    {
+        BEGIN_TEST("AutoreleasePool");
+
+        TEST("AutoreleasePool::Current", AutoreleasePool::Current() == nullptr, "no pool should be in place.");
+
+        bool threw = false;
+        Object *obj = new Object();
+        try { obj->Autorelease(); } catch (const std::runtime_error &) { threw = true; }
+        TEST("Object::Autorelease", threw, "autoreleasing without a pool did not throw.");
+
+        {
+            AutoreleasePool pool;
+            TEST("AutoreleasePool::Current", AutoreleasePool::Current() == &pool, "pool was not pushed.");
+
+            obj->Retain();
+            TEST("Object::Autorelease", obj->Autorelease() == obj, "did not return the object.");
+            TEST("Object::Autorelease", obj->GetReferenceCount() == 2, "object was released immediately.");
+            TEST("AutoreleasePool::Count", pool.Count() == 1, "object was not added to the pool.");
+
+            {
+                AutoreleasePool innerPool;
+                String *str = (new String())->Autorelease<String>();
+                str->Retain();
+                TEST("AutoreleasePool::AutoreleasePool", pool.Count() == 1 && innerPool.Count() == 1, "object was added to the wrong pool.");
+
+                innerPool.Drain();
+                TEST("AutoreleasePool::Drain", innerPool.Count() == 0 && str->GetReferenceCount() == 1, "pool was not drained.");
+                str->Release();
+            }
+
+            TEST("AutoreleasePool::~AutoreleasePool", AutoreleasePool::Current() == &pool, "inner pool was not popped.");
+        }
+
+        TEST("AutoreleasePool::~AutoreleasePool", obj->GetReferenceCount() == 1, "object was not released.");
+        TEST("AutoreleasePool::~AutoreleasePool", AutoreleasePool::Current() == nullptr, "pool was not popped.");
+
+        obj->Release();
+
+        END_TEST;
+    }
+
+    void TestFileReader()
+    {
+        BEGIN_TEST("FileReader");
+
+        char path[64];
+        WriteTemporaryFile("one\ntwo\r\n\nthree", 15, path);
+
+        FileReader *reader = new FileReader(path, 4);
+        String *line = new String();
+
+        TEST("FileReader::ReadLine", reader->ReadLine(line) && line->IsEqual("one"), "did not read the first line.");
+        TEST("FileReader::ReadLine", reader->ReadLine(line) && line->IsEqual("two"), "did not strip the line ending.");
+        TEST("FileReader::ReadLine", reader->ReadLine(line) && line->Empty(), "did not read the empty line.");
+        TEST("FileReader::ReadLine", reader->ReadLine(line) && line->IsEqual("three"), "did not read the unterminated last line.");
+        TEST("FileReader::ReadLine", !reader->ReadLine(line) && reader->AtEnd(), "did not report the end of the file.");
+        reader->Release();
+
+        reader = new FileReader(path);
+        TEST("FileReader::ReadBlock", reader->ReadBlock(line, 10) && line->IsEqual("one\ntwo\r\n\n"), "did not read a full block.");
+        TEST("FileReader::ReadBlock", reader->ReadBlock(line, 10) && line->IsEqual("three"), "did not read the final partial block.");
+        TEST("FileReader::ReadBlock", !reader->ReadBlock(line, 10), "did not report the end of the file.");
+        reader->Release();
+
+        unlink(path);
+
+        bool threw = false;
+        try { new FileReader(path); } catch (const std::runtime_error &) { threw = true; }
+        TEST("FileReader::FileReader", threw, "opening a missing file did not throw.");
+
+        line->Release();
+
+        END_TEST;
+    }
+
+    void TestCycleCollector()
+    {
+        BEGIN_TEST("CycleCollector");
+
+        CycleCollector::SetEnabled(true);
+        TEST("CycleCollector::SetEnabled", CycleCollector::IsEnabled(), "collector was not enabled.");
+
+#ifndef SCOOP_MEMORY_ATOMIC_REFCOUNT
+
+        // Two arrays that contain each other
+
+        Array *first = new Array();
+        Array *second = new Array();
+        String *string = new String("leaf");
+        first->AddObject(second);
+        second->AddObject(first);
+        first->AddObject(string);
+
+        WeakProperty<Array> firstWeak = first, secondWeak = second;
+        WeakProperty<String> stringWeak = string;
+
+        string->Release();
+        second->Release();
+        first->Retain();
+        first->Release();
+        TEST("CycleCollector::AddCandidate", CycleCollector::CandidateCount() == 2, "released containers were not buffered.");
+
+        TEST("CycleCollector::Collect", CycleCollector::Collect() == 0 && !firstWeak.Expired(), "externally referenced cycle was collected.");
+
+        first->Release();
+        TEST("CycleCollector::Collect", CycleCollector::Collect() == 3, "cycle was not collected.");
+        TEST("CycleCollector::Collect", firstWeak.Expired() && secondWeak.Expired() && stringWeak.Expired(), "cycle was not freed.");
+
+        // A dictionary that contains itself
+
+        Dictionary *dict = new Dictionary();
+        dict->SetObject("self", dict);
+        WeakProperty<Dictionary> dictWeak = dict;
+        dict->Release();
+        TEST("CycleCollector::Collect", CycleCollector::Collect() == 1 && dictWeak.Expired(), "self-referencing dictionary was not freed.");
+
+        // A persistent dictionary and an array that contain each other
+
+        PersistentDictionary *empty = new PersistentDictionary();
+        Array *holder = new Array();
+        PersistentDictionary *persistent = empty->With("holder", holder);
+        holder->AddObject(persistent);
+        empty->Release();
+
+        WeakProperty<PersistentDictionary> persistentWeak = persistent;
+        holder->Release();
+        persistent->Release();
+        TEST("CycleCollector::Collect", CycleCollector::Collect() == 2 && persistentWeak.Expired(), "persistent dictionary cycle was not freed.");
+
+        // Arena objects that are still candidates when their arena is destroyed leave the buffer
+
+        {
+            Arena arena;
+            Array *arenaArray = arena.New<Array>();
+            Object *child = new Object();
+            arenaArray->AddObject(child);
+            child->Release();
+
+            arenaArray->Retain();
+            arenaArray->Release();
+            TEST("CycleCollector::AddCandidate", CycleCollector::CandidateCount() == 1, "released arena container was not buffered.");
+        }
+
+        TEST("CycleCollector::RemoveCandidate", CycleCollector::CandidateCount() == 0 && CycleCollector::Collect() == 0, "destroyed arena object stayed a candidate.");
+
+        // Collection is bounded by the number of objects visited per step
+
+        for (size_t i = 0; i < 10; i++)
+        {
+            Array *array = new Array();
+            array->AddObject(array);
+            array->Release();
+        }
+
+        TEST("CycleCollector::Step", CycleCollector::Step(4) == 4 && CycleCollector::CandidateCount() == 6, "step did not stop at its budget.");
+
+        // Draining a pool collects once the threshold is reached
+
+        CycleCollector::SetThreshold(6);
+        {
+            AutoreleasePool pool;
+        }
+
+        TEST("CycleCollector::Poll", CycleCollector::CandidateCount() == 0, "drain did not collect past the threshold.");
+
+        // A root whose reachable objects do not fit in a whole step is deferred to Collect
+
+        Array *head = new Array();
+        Array *previous = head;
+        for (size_t i = 1; i < 100; i++)
+        {
+            Array *next = new Array();
+            previous->AddObject(next);
+            next->Release();
+            previous = next;
+        }
+
+        previous->AddObject(head);
+        head->Release();
+
+        size_t freed = 0;
+        while (CycleCollector::CandidateCount() != 0)
+            freed += CycleCollector::Step(50);
+
+        TEST("CycleCollector::Step", freed == 0 && CycleCollector::DeferredCount() == 100, "roots larger than the step budget were not deferred.");
+        TEST("CycleCollector::Collect", CycleCollector::Collect() == 100 && CycleCollector::DeferredCount() == 0, "deferred root was not collected.");
+
+        // Objects with atomic reference counts are neither buffered nor traversed, so a cycle through one is kept
+
+        ThreadSafe<Array> *shared = new ThreadSafe<Array>();
+        Array *local = new Array();
+        shared->AddObject(local);
+        local->AddObject(shared);
+        local->Release();
+        shared->Retain();
+        shared->Release();
+
+        WeakProperty<Array> sharedWeak = shared;
+        shared->Release();
+        TEST("CycleCollector::AddCandidate", CycleCollector::CandidateCount() == 1, "atomically counted container was buffered.");
+        TEST("CycleCollector::Collect", CycleCollector::Collect() == 0 && !sharedWeak.Expired(), "cycle through an atomically counted container was collected.");
+
+        shared = static_cast<ThreadSafe<Array> *>(sharedWeak.Lock());
+        shared->RemoveObject(local);
+        shared->Release();
+        TEST("CycleCollector::Collect", sharedWeak.Expired(), "breaking the cycle did not free it.");
+#else
+        // Every object uses atomic reference counting, so none is buffered
+
+        Array *cycle = new Array();
+        cycle->AddObject(cycle);
+        cycle->Release();
+        TEST("CycleCollector::AddCandidate", CycleCollector::CandidateCount() == 0, "atomically counted container was buffered.");
+
+        cycle->Retain();
+        cycle->RemoveObject(cycle);
+        cycle->Release();
+#endif
+
+        Array *array = new Array();
+        array->AddObject(array);
+        array->Release();
+        CycleCollector::SetEnabled(false);
+        TEST("CycleCollector::SetEnabled", CycleCollector::CandidateCount() == 0, "disabling did not drop candidates.");
+
+        array->Retain();
+        array->RemoveObject(array);
+        array->Release();
+        CycleCollector::SetThreshold(0);
+
+        END_TEST;
+    }
+
+    void TestArena()
+    {
+        class TestObject : public Object
+        {
+            private:
+                bool &didDelete;
+            public:
+                TestObject(bool &didDelete) : didDelete(didDelete) { }
+                ~TestObject() { this->didDelete = true; }
+        };
+
+        class ThrowingObject : public Object
+        {
+            public:
+                ThrowingObject() { throw Error::Create("ThrowingObject", "ThrowingObject", "Construction failed."); }
+        };
+
+        BEGIN_TEST("Arena");
+
+        bool didDelete = false;
+        Object *external = new Object();
+        String *heapString = new String("heap");
+
+        {
+            Arena arena;
+
+            String *string = arena.New<String>("arena");
+            TEST("Arena::New", string->IsArenaAllocated() && string->IsEqual("arena"), "string was not constructed in the arena.");
+            TEST("Arena::Of", Arena::Of(string) == &arena, "owning arena was not found.");
+            TEST("Arena::Of", Arena::Of(heapString) == nullptr && !heapString->IsArenaAllocated(), "heap object reported an arena.");
+
+            for (size_t i = 0; i < 100; i++)
+                string->Append("0123456789");
+
+            TEST("String::Append", string->Length() == 1005 && string->GetCharacter(1004) == '9', "arena string did not grow.");
+
+            TestObject *object = arena.New<TestObject>(didDelete);
+            object->Release();
+            TEST("Object::Release", didDelete == false, "arena object was destroyed before its arena.");
+
+            Array *array = arena.New<Array>();
+            array->AddObject(external);
+            array->AddObject(string);
+            TEST("Array::AddObject", external->GetReferenceCount() == 2, "arena array did not retain object.");
+
+            bool threw = false;
+            try { arena.New<ThrowingObject>(); } catch (const std::runtime_error &) { threw = true; }
+            Object *afterThrow = new Object();
+            TEST("Arena::New", threw && !afterThrow->IsArenaAllocated(), "failed construction leaked into the next object.");
+            afterThrow->Release();
+
+            for (size_t i = 0; i < 2000; i++)
+                arena.New<String>();
+
+            TEST("Arena::ChunkCount", arena.ChunkCount() > 1, "arena did not allocate further chunks.");
+
+            char path[64];
+            WriteTemporaryFile("mapped contents", 15, path);
+            String *mapped = arena.New<String>();
+            mapped->MapFromFile(path);
+            TEST("String::MapFromFile", mapped->IsEqual("mapped contents"), "arena string did not load the file.");
+            unlink(path);
+        }
+
+        TEST("Arena::~Arena", didDelete, "arena object was not destroyed with its arena.");
+        TEST("Arena::~Arena", external->GetReferenceCount() == 1, "arena array did not release its objects.");
+
+        external->Release();
+        heapString->Release();
+
+        END_TEST;
+    }
+
+    void TestInstrumentation()
+    {
+        BEGIN_TEST("Instrumentation");
+
+#ifdef SCOOP_MEMORY_INSTRUMENTATION
+        TEST("Instrumentation::IsEnabled", Instrumentation::IsEnabled(), "instrumentation was not compiled in.");
+
+        size_t live = Instrumentation::LiveCount();
+        String *string = new String("tracked");
+        Array *array = new Array();
+        TEST("Instrumentation::LiveCount", Instrumentation::LiveCount() == live + 2, "new objects were not counted.");
+        TEST("Instrumentation::PeakCount", Instrumentation::PeakCount() >= live + 2, "peak was not updated.");
+
+        const Instrumentation::TypeStatistics *stringStatistics = nullptr;
+        std::vector<Instrumentation::TypeStatistics> statistics = Instrumentation::GetTypeStatistics();
+        for (const Instrumentation::TypeStatistics &type : statistics)
+        {
+            if (strcmp(type.name, "Scoop::Memory::String") == 0)
+                stringStatistics = &type;
+        }
+
+        TEST("Instrumentation::GetTypeStatistics", stringStatistics != nullptr && stringStatistics->live >= 1, "live strings were not attributed to their type.");
+
+        Instrumentation::TrackHistory(string);
+        array->AddObject(string);
+        array->RemoveObject(string);
+
+        FILE *file = tmpfile();
+        Instrumentation::Report(file);
+
+        char report[4096] = { };
+        rewind(file);
+        fread(report, 1, sizeof(report) - 1, file);
+        fclose(file);
+
+        TEST("Instrumentation::Report", strstr(report, "Retain -> 2") != nullptr && strstr(report, "Release -> 1") != nullptr, "history was not recorded.");
+        TEST("Instrumentation::Report", strstr(report, "Live Scoop::Memory::Array") != nullptr, "live object was not listed.");
+
+        string->Release();
+        array->Release();
+        TEST("Instrumentation::LiveCount", Instrumentation::LiveCount() == live, "destroyed objects were still counted.");
+
+        Instrumentation::ClearHistory();
+#else
+        TEST("Instrumentation::IsEnabled", !Instrumentation::IsEnabled(), "instrumentation was compiled in.");
+        TEST("Instrumentation::LiveCount", Instrumentation::LiveCount() == 0, "disabled instrumentation counted objects.");
+#endif
+
+        END_TEST;
+    }
+
+    void TestPoolAllocator()
+    {
+        BEGIN_TEST("PoolAllocator");
+
+        PoolAllocator::Statistics before = PoolAllocator::GetStatistics();
+
+        void *block = PoolAllocator::Allocate(40);
+        TEST("PoolAllocator::Allocate", block != nullptr && (uintptr_t)block % alignof(std::max_align_t) == 0, "block is not aligned.");
+        PoolAllocator::Deallocate(block, 40);
+
+        void *reused = PoolAllocator::Allocate(48);
+        TEST("PoolAllocator::Allocate", reused == block, "freed block of the same size class was not reused.");
+
+        PoolAllocator::Statistics after = PoolAllocator::GetStatistics();
+        TEST("PoolAllocator::GetStatistics", after.allocations - before.allocations == 2, "pooled allocations were not counted.");
+        TEST("PoolAllocator::GetStatistics", after.hits - before.hits >= 1, "free list hit was not counted.");
+        TEST("PoolAllocator::GetStatistics", after.liveBytes - before.liveBytes == 48, "live bytes were not tracked.");
+
+        void *large = PoolAllocator::Allocate(PoolAllocator::MaximumSize + 1);
+        PoolAllocator::Deallocate(large, PoolAllocator::MaximumSize + 1);
+        TEST("PoolAllocator::Allocate", PoolAllocator::GetStatistics().oversized - after.oversized == 1, "oversized allocation was not forwarded.");
+
+        // Blocks freed on another thread remain usable
+
+        std::thread([reused] { PoolAllocator::Deallocate(reused, 48); }).join();
+        after = PoolAllocator::GetStatistics();
+        TEST("PoolAllocator::Deallocate", after.liveBytes == before.liveBytes, "cross-thread free was not tracked.");
+
+        void *adopted = nullptr;
+        std::thread([&adopted] { adopted = PoolAllocator::Allocate(48); PoolAllocator::Deallocate(adopted, 48); }).join();
+        TEST("PoolAllocator::Allocate", adopted == reused, "blocks of an exited thread were not reused.");
+
+        // A thread that frees more blocks than it keeps hands the surplus to threads that allocate
+
+        std::vector<void *> blocks(PoolAllocator::SlabSize / 496 * 2);
+        std::thread([&blocks] { for (void *&produced : blocks) produced = PoolAllocator::Allocate(496); }).join();
+        for (void *consumed : blocks)
+            PoolAllocator::Deallocate(consumed, 496);
+
+        before = PoolAllocator::GetStatistics();
+        std::thread([] { PoolAllocator::Deallocate(PoolAllocator::Allocate(496), 496); }).join();
+        after = PoolAllocator::GetStatistics();
+        TEST("PoolAllocator::Deallocate", after.hits - before.hits == 1 && after.slabBytes == before.slabBytes, "surplus free blocks were not returned to the depot.");
+
+        // Blocks allocated after the thread cache is gone are full-sized for their class
+
+        struct ExitAllocation
+        {
+            bool *succeeded;
+
+            ~ExitAllocation()
+            {
+                char *late = (char *)PoolAllocator::Allocate(33);
+                memset(late, 0, 48);
+                PoolAllocator::Deallocate(late, 33);
+
+                void *pooled = PoolAllocator::Allocate(48);
+                memset(pooled, 0, 48);
+                PoolAllocator::Deallocate(pooled, 48);
+                *succeeded = true;
+            }
+        };
+
+        bool exitSucceeded = false;
+        std::thread([&exitSucceeded]
+        {
+            thread_local ExitAllocation exitAllocation;
+            exitAllocation.succeeded = &exitSucceeded;
+            PoolAllocator::Deallocate(PoolAllocator::Allocate(40), 40);
+        }).join();
+        TEST("PoolAllocator::Allocate", exitSucceeded, "allocation after the thread cache was destroyed failed.");
+
+        PoolAllocator::Statistics statistics = PoolAllocator::GetStatistics();
+        TEST("PoolAllocator::Statistics", statistics.HitRate() >= 0.0 && statistics.HitRate() <= 1.0, "hit rate is out of range.");
+        TEST("PoolAllocator::Statistics", statistics.Fragmentation() >= 0.0 && statistics.Fragmentation() <= 1.0, "fragmentation is out of range.");
+
+#ifdef SCOOP_MEMORY_POOLED_ALLOCATION
+        before = PoolAllocator::GetStatistics();
+        String *string = new String();
+        after = PoolAllocator::GetStatistics();
+        TEST("Object::operator new", after.allocations - before.allocations == 1, "object was not allocated from the pool.");
+
+        string->Release();
+        TEST("Object::operator delete", PoolAllocator::GetStatistics().liveBytes == before.liveBytes, "object was not returned to the pool.");
+#endif
+
+        END_TEST;
+    }
+
     void TestAll()
     {
         TestObject();
         TestString();
+        TestStringTable();
+        TestStringKernels();
+        TestStringView();
+        TestStringBuilder();
+        TestFileReader();
         TestProperty();
+        TestWeakProperty();
+        TestAtomicProperty();
         TestArray();
         TestDictionary();
+        TestPersistentDictionary();
+        TestAutoreleasePool();
+        TestArena();
+        TestCycleCollector();
+        TestInstrumentation();
+        TestPoolAllocator();
+
+#ifndef SCOOP_MEMORY_COUNT_ALLOCATIONS
+        printf("Allocation tests skipped; run them from a second test binary built with SCOOP_MEMORY_COUNT_ALLOCATIONS.\n");
+#endif
     }
 }
\ No newline at end of file
@@ -4,9 +4,22 @@ namespace Scoop::Memory::TestScoopMemory
 {
     void TestObject();
     void TestString();
+    void TestStringTable();
+    void TestStringKernels();
+    void TestStringView();
+    void TestStringBuilder();
+    void TestFileReader();
     void TestProperty();
+    void TestWeakProperty();
+    void TestAtomicProperty();
     void TestArray();
     void TestDictionary();
+    void TestPersistentDictionary();
+    void TestAutoreleasePool();
+    void TestArena();
+    void TestCycleCollector();
+    void TestInstrumentation();
+    void TestPoolAllocator();
 
     void TestAll();
 }
\ No newline at end of file
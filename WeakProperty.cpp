@@ -0,0 +1,101 @@
+#include "WeakProperty.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace Scoop::Memory
+{
+    // Side table, only populated for objects that have weak references
+
+    static std::mutex &TableMutex()
+    {
+        static std::mutex *mutex = new std::mutex();
+        return *mutex;
+    }
+
+    static std::unordered_map<Object *, WeakReference *> &Table()
+    {
+        static std::unordered_map<Object *, WeakReference *> *table = new std::unordered_map<Object *, WeakReference *>();
+        return *table;
+    }
+
+    // Create
+
+    WeakReference *WeakReference::Create(Object *obj)
+    {
+        if (obj == nullptr)
+            throw Error::NullError("WeakReference", "Create", "obj");
+
+        std::lock_guard<std::mutex> lock(TableMutex());
+
+        WeakReference *&reference = Table()[obj];
+        if (reference == nullptr)
+        {
+            reference = new WeakReference(obj);
+            obj->weaklyReferenced.store(true, std::memory_order_release);
+
+            // Strings are never destroyed by their arena, so it clears their weak references itself
+
+            if (Arena *arena = Arena::Of(obj))
+                arena->weaklyReferenced.push_back(obj);
+        }
+
+        reference->weakCount++;
+        return reference;
+    }
+
+    void WeakReference::ObjectDestroyed(Object *obj)
+    {
+        std::lock_guard<std::mutex> lock(TableMutex());
+
+        auto iterator = Table().find(obj);
+        if (iterator == Table().end())
+            return;
+
+        // Outstanding weak references keep the entry alive, but it no longer refers to the object
+
+        iterator->second->obj = nullptr;
+        Table().erase(iterator);
+        obj->weaklyReferenced.store(false, std::memory_order_relaxed);
+    }
+
+    // Weak reference counting
+
+    void WeakReference::RetainWeak()
+    {
+        std::lock_guard<std::mutex> lock(TableMutex());
+        this->weakCount++;
+    }
+
+    void WeakReference::ReleaseWeak()
+    {
+        std::lock_guard<std::mutex> lock(TableMutex());
+
+        if (--this->weakCount != 0)
+            return;
+
+        if (this->obj != nullptr)
+        {
+            Table().erase(this->obj);
+            this->obj->weaklyReferenced.store(false, std::memory_order_relaxed);
+        }
+
+        delete this;
+    }
+
+    // Access
+
+    Object *WeakReference::Lock()
+    {
+        // The object cannot be destroyed while the table is locked, since its destructor waits for it
+
+        std::lock_guard<std::mutex> lock(TableMutex());
+        return this->obj != nullptr && this->obj->TryRetain() ? this->obj : nullptr;
+    }
+
+    bool WeakReference::Expired()
+    {
+        std::lock_guard<std::mutex> lock(TableMutex());
+        return this->obj == nullptr || this->obj->GetReferenceCount() == 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+namespace Scoop::Memory
+{
+    // Side table entry shared by every weak reference to one object
+
+    class WeakReference
+    {
+        private:
+            Object *obj;
+            size_t weakCount;
+
+            explicit WeakReference(Object *obj) : obj(obj), weakCount(0) { }
+
+        public:
+            // Returns the entry for obj, with its weak count increased
+
+            static WeakReference *Create(Object *obj);
+
+            // Called when an object with weak references is destroyed
+
+            static void ObjectDestroyed(Object *obj);
+
+            // Weak reference counting
+
+            void RetainWeak();
+            void ReleaseWeak();
+
+            // Access
+
+            Object *Lock();
+            bool Expired();
+
+            // Prohibit copying
+
+            WeakReference(const WeakReference &) = delete;
+            void operator=(const WeakReference &) = delete;
+    };
+
+    template <typename T> class WeakProperty
+    {
+        private:
+            WeakReference *reference = nullptr;
+
+        public:
+            WeakProperty() = default;
+            WeakProperty(T *obj) { this->Assign(obj); }
+
+            WeakProperty(const WeakProperty &other) : reference(other.reference)
+            {
+                if (this->reference != nullptr)
+                    this->reference->RetainWeak();
+            }
+
+            ~WeakProperty()
+            {
+                if (this->reference != nullptr)
+                    this->reference->ReleaseWeak();
+            }
+
+            // Access
+
+            T *Lock() const
+            { return this->reference != nullptr ? static_cast<T *>(this->reference->Lock()) : nullptr; }
+
+            bool Expired() const
+            { return this->reference == nullptr || this->reference->Expired(); }
+
+            // Assignment
+
+            void Assign(T *newObj)
+            {
+                WeakReference *newReference = newObj != nullptr ? WeakReference::Create(newObj) : nullptr;
+
+                if (this->reference != nullptr)
+                    this->reference->ReleaseWeak();
+
+                this->reference = newReference;
+            }
+
+            T *operator=(T *newObj)
+            {
+                this->Assign(newObj);
+                return newObj;
+            }
+
+            WeakProperty &operator=(const WeakProperty &other)
+            {
+                if (other.reference != nullptr)
+                    other.reference->RetainWeak();
+
+                if (this->reference != nullptr)
+                    this->reference->ReleaseWeak();
+
+                this->reference = other.reference;
+                return *this;
+            }
+    };
+}
\ No newline at end of file